@@ -165,4 +165,17 @@ AutoControl_StatusTypeDef auto_control_init(auto_control_t *auto_control,
  */
 AutoControl_StatusTypeDef auto_control_step(auto_control_t *auto_control);
 
+/**
+ * @brief Overrides the output of the last control step with the safe state.
+ *
+ * Throttle is cut and the brake and the electronic parking brake are fully
+ * engaged, whatever the state and the driving commands. The gear, the steering
+ * and the state are left as computed, so that the control resumes from a
+ * standstill once the cause of the safe state is gone.
+ *
+ * @param auto_control Pointer to the Auto Control instance.
+ * @return AUTO_CONTROL_OK if the safe state was applied, otherwise AUTO_CONTROL_ERROR.
+ */
+AutoControl_StatusTypeDef auto_control_safe_state(auto_control_t *auto_control);
+
 #endif /* INC_AUTO_CONTROL_H_ */
@@ -9,6 +9,7 @@
 #define INC_AUTO_DATA_FEEDBACK_H_
 
 #include "common_drivers.h"
+#include "can_signals.h"
 
 /* Status Type Definition ---------------------------------------------------*/
 /** @brief Status type definition for Auto Control */
@@ -116,6 +117,72 @@ typedef struct {
 	uint8_t emergency_stop :1;/**< Emergency stop status */
 } auto_data_feedback_t;
 
+/* Freshness Definitions ----------------------------------------------------*/
+/**
+ * @brief Expands one feedback signal line into its index.
+ */
+#define __AUTO_DATA_FEEDBACK_SIGNAL_INDEX(field, start, len, sign) AUTO_DATA_FEEDBACK_SIGNAL_##field,
+
+/**
+ * @brief Indexes of the feedback signals, generated from the signal database.
+ */
+typedef enum {
+	CAN_SIGNALS_AUTO_DATA_FEEDBACK(__AUTO_DATA_FEEDBACK_SIGNAL_INDEX)
+	AUTO_DATA_FEEDBACK_SIGNAL_COUNT
+} auto_data_feedback_signal_t;
+
+/**
+ * @brief Stale policy: the last received values are used.
+ */
+#define AUTO_DATA_FEEDBACK_STALE_HOLD ((uint8_t) 0U)
+/**
+ * @brief Stale policy: speed and steer are extrapolated linearly up to a horizon, then held.
+ */
+#define AUTO_DATA_FEEDBACK_STALE_EXTRAPOLATE ((uint8_t) 1U)
+/**
+ * @brief Stale policy: the last received values are held and the safe state is requested.
+ *
+ * The tracker only raises the request, see auto_data_feedback_is_safe_state():
+ * the control loop acts on it with auto_control_safe_state() and by keeping the
+ * stale steer away from the force feedback regulator. The safe state is
+ * requested only once a frame has been received: before the first one, the
+ * default values are held as with AUTO_DATA_FEEDBACK_STALE_HOLD.
+ */
+#define AUTO_DATA_FEEDBACK_STALE_SAFE_STATE ((uint8_t) 2U)
+
+/**
+ * @brief Age returned for a signal never received.
+ */
+#define AUTO_DATA_FEEDBACK_AGE_NEVER (UINT32_MAX)
+
+/**
+ * @brief Configuration of the feedback freshness tracking.
+ */
+typedef struct {
+	uint32_t max_age_ms; /**< Age past which a signal is stale */
+	uint32_t max_extrapolation_ms; /**< Extrapolation horizon past the last reception */
+	uint8_t stale_policy; /**< Policy applied to the stale signals */
+} auto_data_feedback_freshness_config_t;
+
+/**
+ * @brief Freshness tracker of the auto feedback data.
+ *
+ * It keeps the last received values with the receive tick of each signal and
+ * produces the feedback seen by the control loop, applying the stale policy.
+ */
+typedef struct {
+	const auto_data_feedback_freshness_config_t *config; /**< Pointer to the configuration */
+	auto_data_feedback_t received; /**< Last received values */
+	uint32_t rx_tick[AUTO_DATA_FEEDBACK_SIGNAL_COUNT]; /**< Receive tick of each signal */
+	bool8u rx_valid[AUTO_DATA_FEEDBACK_SIGNAL_COUNT]; /**< Signal received at least once */
+	int16_t prev_speed; /**< Speed of the previous reception, for extrapolation */
+	int16_t prev_steer; /**< Steer of the previous reception, for extrapolation */
+	uint32_t prev_rx_tick; /**< Tick of the previous reception */
+	bool8u prev_valid; /**< Previous reception available */
+	uint32_t stale_cnt; /**< Number of updates applied on stale feedback */
+	bool8u safe_state; /**< Safe state requested by the last apply */
+} auto_data_feedback_tracker_t;
+
 /**
  * @brief Initializes auto data feedback structure with default values.
  *
@@ -128,4 +195,78 @@ typedef struct {
 AutoDataFeedback_StatusTypeDef auto_data_feedback_init(
 		auto_data_feedback_t *auto_data_feedback);
 
+/**
+ * @brief Initializes a feedback freshness tracker.
+ *
+ * No signal is received after initialization, so every signal is stale.
+ *
+ * @param tracker Pointer to the tracker to initialize.
+ * @param config Pointer to the freshness configuration.
+ * @return AUTO_DATA_FEEDBACK_OK if initialization was successful, otherwise AUTO_DATA_FEEDBACK_ERROR.
+ */
+AutoDataFeedback_StatusTypeDef auto_data_feedback_tracker_init(
+		auto_data_feedback_tracker_t *tracker,
+		const auto_data_feedback_freshness_config_t *config);
+
+/**
+ * @brief Records a received feedback frame.
+ *
+ * Every signal carried by the frame takes the receive tick of the frame.
+ *
+ * @param tracker Pointer to the tracker.
+ * @param received Pointer to the decoded feedback frame.
+ * @param rx_tick Tick at which the frame was received.
+ * @return AUTO_DATA_FEEDBACK_OK if the frame was recorded, otherwise AUTO_DATA_FEEDBACK_ERROR.
+ */
+AutoDataFeedback_StatusTypeDef auto_data_feedback_tracker_update(
+		auto_data_feedback_tracker_t *tracker,
+		const auto_data_feedback_t *received, uint32_t rx_tick);
+
+/**
+ * @brief Returns the age of a feedback signal.
+ *
+ * @param tracker Pointer to the tracker.
+ * @param signal Index of the signal.
+ * @param now Current tick in milliseconds.
+ * @return Age of the signal in milliseconds, AUTO_DATA_FEEDBACK_AGE_NEVER if
+ *         it was never received.
+ */
+uint32_t auto_data_feedback_get_age(const auto_data_feedback_tracker_t *tracker,
+		auto_data_feedback_signal_t signal, uint32_t now);
+
+/**
+ * @brief Checks whether a feedback signal is stale.
+ *
+ * @param tracker Pointer to the tracker.
+ * @param signal Index of the signal.
+ * @param now Current tick in milliseconds.
+ * @return CD_TRUE if the signal is older than the configured maximum age or
+ *         was never received, otherwise CD_FALSE.
+ */
+bool8u auto_data_feedback_is_stale(const auto_data_feedback_tracker_t *tracker,
+		auto_data_feedback_signal_t signal, uint32_t now);
+
+/**
+ * @brief Produces the feedback to be used by the control loop.
+ *
+ * Fresh signals are copied as received, stale ones follow the configured policy.
+ *
+ * @param tracker Pointer to the tracker.
+ * @param now Current tick in milliseconds.
+ * @param auto_data_feedback Pointer to the feedback used by the control loop.
+ * @return AUTO_DATA_FEEDBACK_OK if the feedback was produced, otherwise AUTO_DATA_FEEDBACK_ERROR.
+ */
+AutoDataFeedback_StatusTypeDef auto_data_feedback_tracker_apply(
+		auto_data_feedback_tracker_t *tracker, uint32_t now,
+		auto_data_feedback_t *auto_data_feedback);
+
+/**
+ * @brief Checks whether the last apply requested the safe state.
+ *
+ * @param tracker Pointer to the tracker.
+ * @return CD_TRUE if the feedback is stale under AUTO_DATA_FEEDBACK_STALE_SAFE_STATE
+ *         after a frame has been received, otherwise CD_FALSE.
+ */
+bool8u auto_data_feedback_is_safe_state(const auto_data_feedback_tracker_t *tracker);
+
 #endif /* INC_AUTO_DATA_FEEDBACK_H_ */
@@ -15,6 +15,7 @@
 #include "stdint.h"
 #include "stdio.h"
 #include "main.h"
+#include "common_drivers.h"
 
 /* Type Definitions ---------------------------------------------------------*/
 /**
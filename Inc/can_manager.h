@@ -10,6 +10,36 @@
  * This preconfiguration minimizes the risk of errors during runtime by ensuring that
  * critical transmission parameters remain consistent.
  *
+ * Transmission is periodic: the configuration holds a table of TX messages, each one
+ * with its own period and phase offset. Producers only refresh the payload of a message,
+ * while `can_manager_tx_step()` releases every message at its own rate. Giving messages
+ * with the same period different phases spreads the frames over time, so that the bus
+ * load stays smooth instead of bursting.
+ *
+ * Transmission never blocks: every TX message follows a small state machine
+ * (idle, queued, pending in a mailbox, aborting) advanced by the scheduler and by the
+ * HAL TX mailbox complete and abort complete callbacks, which the CAN Manager owns.
+ * Each message is a latest-value slot: a new payload replaces the unsent one, and a
+ * release finding the previous frame still in a mailbox waits behind it instead of
+ * aborting it. Only a frame still pending after a whole further period is aborted.
+ * All three mailboxes are used and every time one becomes empty the interrupt refills
+ * it with the queued message having the lowest identifier, so urgent IDs go out first.
+ *
+ * Reception is interrupt driven: the CAN Manager owns the HAL RX FIFO callbacks and
+ * pushes every received frame, together with its receive tick and hardware timestamp,
+ * into a lock-free single-producer/single-consumer ring. The consumer pops complete
+ * frames with `can_manager_rx_pop()`, so it never sees a frame being written and only
+ * decodes when something new has arrived. The acceptance filters are programmed in
+ * ID-list mode from the RX messages of the signal database, so frames the firmware does
+ * not decode are rejected by the hardware and never raise an interrupt.
+ *
+ * Runtime statistics (estimated bus load, error counters, RX overruns, TX counts and
+ * a histogram of the TX latency) are kept up to date by the interrupts and by
+ * `can_manager_tx_step()`, and can be read with `can_manager_get_stats()`. The application must not define
+ * `HAL_CAN_RxFifo0MsgPendingCallback`, `HAL_CAN_RxFifo1MsgPendingCallback` or the
+ * `HAL_CAN_TxMailboxNCompleteCallback`/`HAL_CAN_TxMailboxNAbortCallback` functions or
+ * `HAL_CAN_ErrorCallback` itself.
+ *
  * Created on: Jun 26, 2024
  * Authors: Alessio Guarini, Antonio Vitale
  */
@@ -20,6 +50,7 @@
 #include <stdint.h>
 #include "can.h"
 #include "common_drivers.h"
+#include "can_signals.h"
 
 /* Type Definitions ---------------------------------------------------------*/
 /**
@@ -44,8 +75,75 @@ typedef uint8_t CanManager_StatusTypeDef;
  */
 #define CAN_MANAGER_MESSAGE_NOT_PENDING (0U)
 
+/**
+ * @brief Maximum number of periodic TX messages.
+ */
+#define CAN_MANAGER_MAX_TX_MESSAGES (8U)
+
+/**
+ * @brief Number of bxCAN TX mailboxes.
+ */
+#define CAN_MANAGER_TX_MAILBOX_COUNT (3U)
+
+/**
+ * @brief Owner of a TX mailbox not used by any message.
+ */
+#define CAN_MANAGER_TX_NO_OWNER ((uint8_t) 0xFFU)
+
+/**
+ * @brief TX message states.
+ */
+#define CAN_MANAGER_TX_IDLE     ((uint8_t) 0U) /**< Nothing to be sent */
+#define CAN_MANAGER_TX_QUEUED   ((uint8_t) 1U) /**< Released, waiting for a free mailbox */
+#define CAN_MANAGER_TX_PENDING  ((uint8_t) 2U) /**< Frame in a mailbox */
+#define CAN_MANAGER_TX_ABORTING ((uint8_t) 3U) /**< Stale frame being aborted, a fresh release waits behind it */
+#define CAN_MANAGER_TX_UPDATED  ((uint8_t) 4U) /**< Frame in a mailbox, a fresh release waits behind it */
+
+/**
+ * @brief First filter bank assigned to CAN2, CAN1 owns the banks below it.
+ */
+#define CAN_MANAGER_SLAVE_START_FILTER_BANK (14U)
+
+/**
+ * @brief Number of standard identifiers held by a filter bank in 16-bit ID-list mode.
+ */
+#define CAN_MANAGER_IDS_PER_FILTER_BANK (4U)
+
+/**
+ * @brief Number of bins of the TX latency histogram.
+ *
+ * Bin 0 counts latencies below 1 ms, bin n counts latencies in [2^(n-1), 2^n) ms,
+ * the last bin also counts every longer latency.
+ */
+#define CAN_MANAGER_TX_LATENCY_BINS (8U)
+
+/**
+ * @brief Window over which the bus load is estimated, in milliseconds.
+ */
+#define CAN_MANAGER_BUS_LOAD_WINDOW_MS (1000U)
+
+/**
+ * @brief Number of frames held by the RX ring, must be a power of two.
+ */
+#define CAN_MANAGER_RX_RING_SIZE (8U)
+
+#if ((CAN_MANAGER_RX_RING_SIZE & (CAN_MANAGER_RX_RING_SIZE - 1U)) != 0U)
+#error "CAN_MANAGER_RX_RING_SIZE must be a power of two"
+#endif
+
 
 /* Data Structure Definitions -----------------------------------------------*/
+/**
+ * @brief Configuration of a periodic TX message.
+ *
+ * The deadline of each release is the next release, one period later.
+ */
+typedef struct {
+	CAN_TxHeaderTypeDef tx_header; /**< Header of the frame */
+	uint32_t period_ms; /**< Transmission period in milliseconds */
+	uint32_t phase_ms; /**< Offset of the first release from initialization, in milliseconds */
+} can_manager_tx_message_config_t;
+
 /**
  * @brief Configuration structure for CAN Manager.
  *
@@ -53,11 +151,69 @@ typedef uint8_t CanManager_StatusTypeDef;
  */
 typedef struct {
 	CAN_HandleTypeDef *hcan; /**< Pointer to the CAN handle */
-	const CAN_TxHeaderTypeDef auto_control_tx_header; /**< Header for auto control transmission */
+	const can_manager_tx_message_config_t *tx_messages; /**< Table of periodic TX messages */
+	uint8_t tx_message_count; /**< Number of entries in the TX message table */
 	uint32_t auto_data_feedback_rx_fifo; /**< FIFO for auto data feedback reception */
 	uint32_t auto_data_feedback_rx_interrupt; /**< Interrupt for auto data feedback reception */
+	uint32_t rx_filter_bank; /**< First filter bank used for reception */
+	uint32_t bitrate; /**< Nominal bit rate of the bus in bit/s, used to estimate the bus load */
 } can_manager_config_t;
 
+/**
+ * @brief Runtime state of a periodic TX message.
+ */
+typedef struct {
+    uint8_t data[CAN_MANAGER_TX_DATA_SIZE];         /**< Latest payload of the message */
+    uint32_t mailbox;                               /**< Mailbox used by the last transmission */
+    uint32_t next_release;                          /**< Tick of the next release */
+    volatile uint8_t state;                         /**< TX state, also advanced by the TX interrupts */
+    uint32_t tx_cnt;                                /**< Number of transmitted frames, the message owns its identifier */
+    uint32_t submit_tick;                           /**< Tick at which the frame entered its mailbox */
+    uint32_t deadline_miss_cnt;                     /**< Number of releases not transmitted within their period */
+} can_manager_tx_slot_t;
+
+/**
+ * @brief Frame received from the CAN bus.
+ */
+typedef struct {
+    CAN_RxHeaderTypeDef header;                     /**< Receive header, Timestamp holds the hardware time stamp */
+    uint8_t data[CAN_MANAGER_RX_DATA_SIZE];         /**< Payload of the frame */
+    uint32_t rx_tick;                               /**< Tick at which the frame was taken from the FIFO */
+} can_manager_rx_frame_t;
+
+/**
+ * @brief Single-producer/single-consumer ring of received frames.
+ *
+ * The RX interrupt is the only writer of `head`, the consumer is the only
+ * writer of `tail`. Both indexes run freely and are masked on access.
+ */
+typedef struct {
+    can_manager_rx_frame_t frames[CAN_MANAGER_RX_RING_SIZE]; /**< Frame storage */
+    uint32_t head;                                  /**< Next slot to be written by the interrupt */
+    uint32_t tail;                                  /**< Next slot to be read by the consumer */
+    uint32_t overrun_cnt;                           /**< Frames dropped because the ring was full */
+} can_manager_rx_ring_t;
+
+/**
+ * @brief Runtime statistics of the CAN bus.
+ *
+ * The bus load only accounts for the frames seen by the DBW board: the transmitted
+ * ones and the ones accepted by the filters. Frame lengths are estimated with the
+ * worst case bit stuffing.
+ */
+typedef struct {
+    uint32_t bus_load_permille;                     /**< Bus load estimated on the last window, in per mille */
+    uint32_t window_bits;                           /**< Bits seen in the current window */
+    uint32_t window_start;                          /**< Tick at which the current window started */
+    uint8_t tec;                                    /**< Transmit error counter */
+    uint8_t rec;                                    /**< Receive error counter */
+    uint8_t lec;                                    /**< Last error code */
+    uint8_t error_flags;                            /**< Bus-off, error passive and error warning flags (ESR[2:0]) */
+    uint32_t rx_fifo_overrun_cnt;                   /**< Frames lost by the hardware RX FIFO */
+    uint32_t rx_cnt;                                /**< Number of received frames */
+    uint32_t tx_latency_hist[CAN_MANAGER_TX_LATENCY_BINS]; /**< Time from submission to transmission complete */
+} can_manager_stats_t;
+
 /**
  * @brief Structure representing a CAN Manager instance.
  *
@@ -65,10 +221,12 @@ typedef struct {
  */
 typedef struct {
     can_manager_config_t const *config;             /**< Pointer to the CAN Manager configuration */
-    uint32_t auto_control_tx_mailbox;               /**< Mailbox for auto control transmission */
-    CAN_RxHeaderTypeDef RxHeader;                   /**< CAN receive header */
-    uint8_t tx_data[CAN_MANAGER_TX_DATA_SIZE];      /**< Transmission data buffer */
-    uint8_t rx_data[CAN_MANAGER_RX_DATA_SIZE];      /**< Reception data buffer */
+    can_manager_tx_slot_t tx_slots[CAN_MANAGER_MAX_TX_MESSAGES]; /**< State of the periodic TX messages */
+    uint8_t tx_mailbox_owner[CAN_MANAGER_TX_MAILBOX_COUNT]; /**< Index of the message held by each mailbox */
+    uint8_t tx_order[CAN_MANAGER_MAX_TX_MESSAGES];  /**< Message indexes sorted by increasing identifier */
+    uint32_t tx_abort_cnt;                          /**< Number of aborted frames */
+    can_manager_stats_t stats;                      /**< Runtime statistics */
+    can_manager_rx_ring_t rx_ring;                  /**< Ring of received frames */
     uint32_t max_can_occupancy_cnt;                 /**< Maximum CAN occupancy count */
     uint32_t can_occupancy_cnt;                     /**< Current CAN occupancy count */
 } can_manager_t;
@@ -84,6 +242,11 @@ typedef struct {
  */
 #define CAN_MANAGER_ERROR                                     ((CanManager_StatusTypeDef) 1U)
 
+/**
+ * @brief Macro indicating that no received frame is available.
+ */
+#define CAN_MANAGER_RX_EMPTY                                  ((CanManager_StatusTypeDef) 2U)
+
 /**
  * @brief The maximum number of times a transmission can be aborted.
  *
@@ -96,15 +259,16 @@ typedef struct {
 /**
  * @brief Auto Control CAN frame ID.
  */
-#define AUTO_CONTROL_FRAME_ID                                 ((uint8_t)387U)
+#define AUTO_CONTROL_FRAME_ID                                 (CAN_SIGNALS_AUTO_CONTROL_ID)
 
 /* Function Prototypes ------------------------------------------------------*/
 /**
  * @brief Initializes the CAN Manager.
  *
  * This function initializes the CAN Manager with the specified configuration.
- * It starts the CAN peripheral and activates the notification for the
- * auto data feedback reception.
+ * It programs the acceptance filters, starts the CAN peripheral and activates
+ * the notification for the auto data feedback reception. Only one CAN Manager
+ * instance can receive.
  *
  * @param can_manager Pointer to the CAN Manager instance.
  * @param config Pointer to the configuration structure.
@@ -114,17 +278,61 @@ CanManager_StatusTypeDef can_manager_init(can_manager_t *can_manager,
 		const can_manager_config_t *config);
 
 /**
- * @brief Transmits Auto Control data.
+ * @brief Updates the payload of a periodic TX message.
+ *
+ * The new payload replaces the previous one and is transmitted at the next
+ * release of the message.
+ *
+ * @param can_manager Pointer to the CAN Manager instance.
+ * @param tx_index Index of the message in the TX message table.
+ * @param can_data Pointer to the new payload.
+ * @return CAN_MANAGER_OK if the payload was updated, otherwise CAN_MANAGER_ERROR.
+ */
+CanManager_StatusTypeDef can_manager_update_tx_data(can_manager_t *can_manager,
+		uint8_t tx_index, const uint8_t *can_data);
+
+/**
+ * @brief Runs the periodic TX schedule.
+ *
+ * This function releases every message whose release time has come and
+ * submits the released messages to the free mailboxes, without waiting for
+ * the peripheral. A release that is not transmitted before the next one is
+ * counted as a deadline miss. It is meant to be called with a period shorter
+ * than the shortest message period, always from the same task: the schedule
+ * is not protected against concurrent callers.
+ *
+ * @param can_manager Pointer to the CAN Manager instance.
+ * @param now Current tick in milliseconds.
+ * @return CAN_MANAGER_OK if the bus keeps up with the schedule, otherwise
+ *         CAN_MANAGER_ERROR.
+ */
+CanManager_StatusTypeDef can_manager_tx_step(can_manager_t *can_manager,
+		uint32_t now);
+
+/**
+ * @brief Pops the oldest received frame.
+ *
+ * This function must be called from a single consumer context.
+ *
+ * @param can_manager Pointer to the CAN Manager instance.
+ * @param frame Pointer where the frame is copied.
+ * @return CAN_MANAGER_OK if a frame was popped, CAN_MANAGER_RX_EMPTY if the
+ *         ring is empty, otherwise CAN_MANAGER_ERROR.
+ */
+CanManager_StatusTypeDef can_manager_rx_pop(can_manager_t *can_manager,
+		can_manager_rx_frame_t *frame);
+
+/**
+ * @brief Copies the runtime statistics.
  *
- * This function transmits the Auto Control data using the CAN interface.
- * It checks if the mailbox is available for transmission, attempts to send
- * the data, and manages the number of transmission retries.
+ * The RX ring overruns are in `rx_ring.overrun_cnt` and the TX count of each
+ * identifier in the `tx_cnt` of its message.
  *
  * @param can_manager Pointer to the CAN Manager instance.
- * @param can_data Pointer to the data to be transmitted.
- * @return CAN_MANAGER_OK if transmission was successful, otherwise CAN_MANAGER_ERROR.
+ * @param stats Pointer where the statistics are copied.
+ * @return CAN_MANAGER_OK if the statistics were copied, otherwise CAN_MANAGER_ERROR.
  */
-CanManager_StatusTypeDef can_manager_auto_control_tx(can_manager_t *can_manager,
-		const uint8_t *can_data);
+CanManager_StatusTypeDef can_manager_get_stats(const can_manager_t *can_manager,
+		can_manager_stats_t *stats);
 
 #endif /* INC_CAN_MANAGER_H_ */
@@ -0,0 +1,83 @@
+/*
+ * @file can_signals.h
+ * @brief CAN Signal Database
+ *
+ * This file is the single description of the chassis CAN frames handled by
+ * the firmware. It is written as a set of X-macro tables laid out like a DBC
+ * file: one table lists the messages, then one table per message lists its
+ * signals. The CAN Parser expands these tables into the frame encoders and
+ * decoders, so adding a signal or a chassis message only requires new lines
+ * here and no hand-written bit fiddling.
+ *
+ * Message lines read:
+ *     X(name, id, dlc, type, direction)
+ * where `name` selects the signal table CAN_SIGNALS_<name>, `type` is the
+ * structure holding the logical values and `direction` is CAN_SIGNALS_TX or
+ * CAN_SIGNALS_RX as seen from the DBW board.
+ *
+ * Signal lines read:
+ *     X(field, start_bit, length, sign)
+ * where `field` is the member of the message structure, `start_bit` is the
+ * position of the signal LSB inside the 64-bit little endian payload (Intel
+ * byte order, "@1" in DBC syntax), `length` is its width in bits and `sign`
+ * is SIGNED or UNSIGNED.
+ *
+ * Created on: Jun 25, 2024
+ * Authors: Alessio Guarini, Antonio Vitale
+ */
+
+#ifndef INC_CAN_SIGNALS_H_
+#define INC_CAN_SIGNALS_H_
+
+/* Direction Definitions ----------------------------------------------------*/
+/** @brief Message transmitted by the DBW board */
+#define CAN_SIGNALS_TX                        (0U)
+/** @brief Message received by the DBW board */
+#define CAN_SIGNALS_RX                        (1U)
+
+/* Frame Identifiers --------------------------------------------------------*/
+/** @brief Auto Control frame identifier */
+#define CAN_SIGNALS_AUTO_CONTROL_ID           (0x183U)
+/** @brief Auto Data Feedback frame identifier */
+#define CAN_SIGNALS_AUTO_DATA_FEEDBACK_ID     (0x193U)
+
+/* Messages -----------------------------------------------------------------*/
+/*      name                id                                  dlc  type                  direction      */
+#define CAN_SIGNALS_MESSAGES(X) \
+	X(AUTO_CONTROL,       CAN_SIGNALS_AUTO_CONTROL_ID,        8U,  auto_control_data_t,  CAN_SIGNALS_TX) \
+	X(AUTO_DATA_FEEDBACK, CAN_SIGNALS_AUTO_DATA_FEEDBACK_ID,  8U,  auto_data_feedback_t, CAN_SIGNALS_RX)
+
+/* BO_ 0x183 AUTO_CONTROL ---------------------------------------------------*/
+/*      field             start  length  sign     */
+#define CAN_SIGNALS_AUTO_CONTROL(X) \
+	X(speed,              0U,    16U,    UNSIGNED) \
+	X(braking,            16U,   16U,    UNSIGNED) \
+	X(steering,           32U,   16U,    SIGNED)   \
+	X(gear_shift,         48U,   4U,     UNSIGNED) \
+	X(mode_selection,     52U,   4U,     UNSIGNED) \
+	X(left_light,         56U,   1U,     UNSIGNED) \
+	X(state_control,      57U,   1U,     UNSIGNED) \
+	X(right_light,        58U,   1U,     UNSIGNED) \
+	X(EBP,                59U,   1U,     UNSIGNED) \
+	X(front_light,        60U,   1U,     UNSIGNED) \
+	X(advanced_mode,      61U,   1U,     UNSIGNED) \
+	X(speed_mode,         62U,   1U,     UNSIGNED) \
+	X(self_driving,       63U,   1U,     UNSIGNED)
+
+/* BO_ 0x193 AUTO_DATA_FEEDBACK ---------------------------------------------*/
+/*      field             start  length  sign     */
+#define CAN_SIGNALS_AUTO_DATA_FEEDBACK(X) \
+	X(speed,              0U,    16U,    SIGNED)   \
+	X(steer,              16U,   16U,    SIGNED)   \
+	X(braking,            32U,   16U,    UNSIGNED) \
+	X(gear,               48U,   2U,     UNSIGNED) \
+	X(mode,               52U,   2U,     UNSIGNED) \
+	X(l_steer_light,      56U,   1U,     UNSIGNED) \
+	X(r_steer_light,      57U,   1U,     UNSIGNED) \
+	X(tail_light,         58U,   1U,     UNSIGNED) \
+	X(braking_light,      59U,   1U,     UNSIGNED) \
+	X(vehicle_status,     60U,   1U,     UNSIGNED) \
+	X(vehicle_mode,       61U,   1U,     UNSIGNED) \
+	X(emergency_stop,     62U,   1U,     UNSIGNED)
+
+#endif /* INC_CAN_SIGNALS_H_ */
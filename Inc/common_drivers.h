@@ -36,6 +36,31 @@ typedef uint8_t bool8u;
  */
 #define CD_FALSE ((bool8u) 0U)
 
+/**
+ * @brief Millisecond time base used by the drivers.
+ *
+ * Defaults to the HAL tick. It can be redefined at compile time (e.g. with
+ * -DCD_GET_TICK=virtual_clock_get_tick) to drive the modules from a virtual
+ * clock when running them off-target.
+ */
+#ifndef CD_GET_TICK
+#define CD_GET_TICK() HAL_GetTick()
+#endif
+
+/**
+ * @brief Critical section used to protect data shared with interrupts.
+ *
+ * Defaults to the CMSIS interrupt masking intrinsics. Both macros can be
+ * redefined at compile time together with CD_GET_TICK.
+ */
+#ifndef CD_ENTER_CRITICAL
+#define CD_ENTER_CRITICAL() __disable_irq()
+#endif
+
+#ifndef CD_EXIT_CRITICAL
+#define CD_EXIT_CRITICAL() __enable_irq()
+#endif
+
 /**
  * Clamps a float value to a specified range.
  *
@@ -63,6 +88,28 @@ float clamp_float(float x, float min, float max);
 float map_value_float(float x, float in_min, float in_max, float out_min,
 		float out_max);
 
+/**
+ * @brief Slope of a linear mapping between two ranges.
+ *
+ * Meant to be used with constant ranges, so that the division is folded by the
+ * compiler and map_value_float_scaled() runs without any division.
+ */
+#define MAP_VALUE_SCALE(in_min, in_max, out_min, out_max) \
+	((((float) (out_max)) - ((float) (out_min))) / (((float) (in_max)) - ((float) (in_min))))
+
+/**
+ * Maps a float value from one range to another using a precomputed slope.
+ *
+ * @param[in] x The value to map.
+ * @param[in] in_min The minimum value of the input range.
+ * @param[in] in_max The maximum value of the input range.
+ * @param[in] out_min The minimum value of the output range.
+ * @param[in] scale The slope of the mapping, see MAP_VALUE_SCALE.
+ * @return The mapped value.
+ */
+float map_value_float_scaled(float x, float in_min, float in_max, float out_min,
+		float scale);
+
 /**
  * @brief Calculates a new smoothed value.
  *
@@ -89,4 +136,16 @@ float calculate_new_smoothed_value(float current_value, float set_point,
  */
 bool8u check_wheel_is_linked(USBH_HandleTypeDef *host_handle);
 
+/**
+ * @def USE_SINGLE_PRECISION
+ * @brief Macro to enable the float-only numeric path.
+ *
+ * If defined (e.g. with -DUSE_SINGLE_PRECISION), the PID regulator works in
+ * single precision. The project sources are then meant to be built with
+ * -Werror=double-promotion -Werror=float-conversion -fsingle-precision-constant,
+ * so that no soft-double code can slip into the control path on the single
+ * precision FPU. The flags belong to the project targets only: the HAL, the
+ * middlewares and the application code are left untouched.
+ */
+
 #endif /* INC_COMMON_DRIVERS_H_ */
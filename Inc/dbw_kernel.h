@@ -33,7 +33,21 @@
 /* Defines ------------------------------------------------------------------*/
 #define UPDATE_STATE_PERIOD_MS                    (20U)
 #define URB_TX_PERIOD_MS                          (2U)
+#define CAN_TX_PERIOD_MS                          (1U)
+/* Past FEEDBACK_MAX_AGE_MS without a 0x193 frame, once one has been received,
+ * the update step is in the safe state: speed 0, full braking and EBP engaged,
+ * and the wheel is no longer driven toward the stale steer */
+#define FEEDBACK_MAX_AGE_MS                       (100U)
+#define FEEDBACK_MAX_EXTRAPOLATION_MS             (100U)
+/* A constant force command is sent at most every other update step, and only
+ * if it moved by more than FF_DEADBAND: ff_traffic_test counts the held steer
+ * URB traffic down to about 40% of one command per update step */
+#define FF_DEADBAND                               (32U)
+#define FF_MIN_RESEND_MS                          (2U * UPDATE_STATE_PERIOD_MS)
 #define USE_CAN
+/* By default the update step runs the CAN TX schedule. An application with a
+ * dedicated task calling dbw_kernel_can_tx_step() every CAN_TX_PERIOD_MS
+ * defines USE_CAN_TX_TASK (e.g. with -DUSE_CAN_TX_TASK) instead */
 
 /* Type Definitions ---------------------------------------------------------*/
 /**
@@ -54,9 +68,6 @@ extern USBH_HandleTypeDef hUsbHostFS;
  * information about the current HID report from the T818 device.
  */
 typedef struct {
-    osMessageQId urb_queueHandle; /* Queue for USB Messages */
-    uint8_t urb_queueBuffer[40 * sizeof(urb_interr_msg_t)]; /* Buffer for USB Messages */
-    osStaticMessageQDef_t urb_queueControlBlock; /* Control block for USB Messages */
     urb_sender_t urb_sender; /* URB Sender instance */
 
     t818_drive_control_t drive_control;
@@ -65,6 +76,8 @@ typedef struct {
     pid_t pid;
     rotation_manager_t rotation_manager;
     can_manager_t can_manager;
+    auto_data_feedback_tracker_t auto_data_feedback_tracker; /* Freshness of the Auto Data Feedback */
+    uint32_t auto_data_feedback_rx_timestamp; /* Hardware timestamp of the last Auto Data Feedback frame */
 } dbw_kernel_t;
 
 /* Defines ------------------------------------------------------------------*/
@@ -78,6 +91,11 @@ typedef struct {
  */
 #define DBW_ERROR                           ((DBWKernel_StatusTypeDef) 1U)
 
+/**
+ * @brief Index of the Auto Control frame in the periodic CAN TX table.
+ */
+#define DBW_AUTO_CONTROL_TX_INDEX           (0U)
+
 /* Function Prototypes ------------------------------------------------------*/
 /**
  * @brief Retrieve the singleton instance of the DBW Kernel state.
@@ -113,4 +131,38 @@ DBWKernel_StatusTypeDef dbw_kernel_update_state_step(void);
  */
 DBWKernel_StatusTypeDef dbw_kernel_urb_tx_step(void);
 
+/**
+ * @brief Wait for a URB event, then perform a URB transmission step.
+ *
+ * Meant to be the body of the URB transmission task loop, without any delay:
+ * it blocks until the previous URB completes or a packet is submitted, or at
+ * most URB_TX_PERIOD_MS.
+ *
+ * @return Status of the URB transmission step.
+ */
+DBWKernel_StatusTypeDef dbw_kernel_urb_tx_wait_step(void);
+
+/**
+ * @brief Forward a URB state change to the URB transmission task.
+ *
+ * Meant to be called from HAL_HCD_HC_NotifyURBChange_Callback.
+ *
+ * @param chnum Host channel, which is also the pipe number.
+ */
+void dbw_kernel_urb_notify_from_isr(uint8_t chnum);
+
+/**
+ * @brief Perform a CAN transmission step for the DBW Kernel module.
+ *
+ * This function runs the periodic CAN TX schedule. Calling it every
+ * CAN_TX_PERIOD_MS lets each message be released at its own period and phase.
+ * It exists only with USE_CAN_TX_TASK, and the dedicated CAN TX task must be
+ * its only caller; otherwise the update step runs the schedule.
+ *
+ * @return Status of the CAN transmission step.
+ */
+#if defined(USE_CAN) && defined(USE_CAN_TX_TASK)
+DBWKernel_StatusTypeDef dbw_kernel_can_tx_step(void);
+#endif
+
 #endif /* INC_DBW_KERNEL_H_ */
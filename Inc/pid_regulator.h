@@ -30,6 +30,53 @@
 	#define USE_CLAMPING
 #endif
 
+/**
+ * @def USE_FIXED_POINT_PID
+ * @brief Macro to select the fixed-point PID engine.
+ *
+ * If defined, the regulator runs entirely on the integer pipeline: gains are
+ * stored in Q15.16 format, error and output are plain integers and the output
+ * saturates directly to [ukmin, ukmax]. Otherwise the engine works in single
+ * precision if USE_SINGLE_PRECISION is defined, in double precision if not.
+ */
+
+#ifdef USE_FIXED_POINT_PID
+	/** @brief Number of fractional bits of a fixed-point gain. */
+	#define PID_GAIN_FRAC_BITS	(16U)
+
+	/** @brief Gain type, Q15.16 fixed-point. */
+	typedef int32_t pid_gain_t;
+
+	/** @brief Error and control output type. */
+	typedef int32_t pid_signal_t;
+
+	/**
+	 * @brief Converts a real constant to a gain at compile time.
+	 *
+	 * Only meant for constant expressions, so that no floating point
+	 * operation is left in the generated code.
+	 */
+	#define PID_GAIN(x)		((pid_gain_t)(((x) * 65536.0) + (((x) >= 0.0) ? 0.5 : -0.5)))
+#elif defined(USE_SINGLE_PRECISION)
+	/** @brief Gain type, single precision. */
+	typedef float pid_gain_t;
+
+	/** @brief Error and control output type. */
+	typedef float pid_signal_t;
+
+	/** @brief Converts a real constant to a gain. */
+	#define PID_GAIN(x)		((pid_gain_t)(x))
+#else
+	/** @brief Gain type, double precision. */
+	typedef double pid_gain_t;
+
+	/** @brief Error and control output type. */
+	typedef double pid_signal_t;
+
+	/** @brief Converts a real constant to a gain. */
+	#define PID_GAIN(x)		((pid_gain_t)(x))
+#endif
+
 typedef uint8_t PID_StatusTypeDef;
 
 #define PID_OK       	((PID_StatusTypeDef) 0U)
@@ -37,9 +84,9 @@ typedef uint8_t PID_StatusTypeDef;
 
 
 
-#define PID_KP			((double)-4.4795)
-#define PID_KI			((double)0.00)
-#define PID_KD			((double)-10.2476)
+#define PID_KP			PID_GAIN(-4.4795)
+#define PID_KI			PID_GAIN(0.00)
+#define PID_KD			PID_GAIN(-10.2476)
 
 /**
  * @struct pid_t
@@ -49,16 +96,16 @@ typedef uint8_t PID_StatusTypeDef;
  */
 typedef struct {
 
-	double ki; 		/**< Integral gain */
-	double kp; 		/**< Proportional gain */
-	double kd; 		/**< Derivative gain */
-	double e_old; 	/**< Previous error value */
-	double u_old; 	/**< Previous control output value */
+	pid_gain_t ki; 		/**< Integral gain */
+	pid_gain_t kp; 		/**< Proportional gain */
+	pid_gain_t kd; 		/**< Derivative gain */
+	pid_signal_t e_old; 	/**< Previous error value */
+	pid_signal_t u_old; 	/**< Previous control output value */
 
 	#ifdef USE_CLAMPING
-		double	ukmax; 	/**< Maximum control output value */
-		double	ukmin; 	/**< Minimum control output value */
-		double sk; 		/**< Saturator gain */
+		pid_signal_t	ukmax; 	/**< Maximum control output value */
+		pid_signal_t	ukmin; 	/**< Minimum control output value */
+		pid_signal_t sk; 		/**< Saturator gain */
 	#endif
 
 } pid_t;
@@ -75,7 +122,7 @@ typedef struct {
 	 * @param kd Derivative gain
 	 * @return PID_OK if successful, PID_ERROR otherwise
 	 */
-	PID_StatusTypeDef pid_init(pid_t *pid, double kp, double ki, double kd);
+	PID_StatusTypeDef pid_init(pid_t *pid, pid_gain_t kp, pid_gain_t ki, pid_gain_t kd);
 #elif defined(USE_CLAMPING)
 	/**
 	 * @brief Initialize the PID regulator with clamping
@@ -90,7 +137,7 @@ typedef struct {
 	 * @param ukmax Maximum control output value
 	 * @return PID_OK if successful, PID_ERROR otherwise
 	 */
-	PID_StatusTypeDef pid_init(pid_t *pid, double kp, double ki, double kd, double ukmin, double ukmax);
+	PID_StatusTypeDef pid_init(pid_t *pid, pid_gain_t kp, pid_gain_t ki, pid_gain_t kd, pid_signal_t ukmin, pid_signal_t ukmax);
 #endif
 
 /**
@@ -103,7 +150,7 @@ typedef struct {
  * @param u Pointer to store the control output value
  * @return PID_OK if successful, PID_ERROR otherwise
  */
-PID_StatusTypeDef pid_calculate_output(pid_t *pid, double e, double *u);
+PID_StatusTypeDef pid_calculate_output(pid_t *pid, pid_signal_t e, pid_signal_t *u);
 
 /**
  * @brief Change the parameters of the PID regulator
@@ -116,6 +163,6 @@ PID_StatusTypeDef pid_calculate_output(pid_t *pid, double e, double *u);
  * @param kd New derivative gain
  * @return PID_OK if successful, PID_ERROR otherwise
  */
-PID_StatusTypeDef pid_change_parameters(pid_t *pid, double kp, double ki, double kd);
+PID_StatusTypeDef pid_change_parameters(pid_t *pid, pid_gain_t kp, pid_gain_t ki, pid_gain_t kd);
 
 #endif /* INC_PID_REGULATOR_H_ */
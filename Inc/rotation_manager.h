@@ -16,16 +16,76 @@ typedef uint8_t Rotation_Manager_StatusTypeDef;
 #define ROTATION_MANAGER_OK       	((Rotation_Manager_StatusTypeDef) 0U)
 #define ROTATION_MANAGER_ERROR    	((Rotation_Manager_StatusTypeDef) 1U)
 
+/** @brief Pending URB packets from which the force feedback link is considered congested */
+#define ROTATION_MANAGER_CONGESTED_PENDING_CNT	(4U)
+/** @brief Largest number of updates between two force feedback commands */
+#define ROTATION_MANAGER_MAX_FF_DIVIDER			(8U)
+/** @brief Window over which the URB completion rate is measured */
+#define ROTATION_MANAGER_RATE_WINDOW_MS			(100U)
+
+/**
+ * @brief Rotation manager configuration.
+ */
+typedef struct {
+	uint16_t ff_deadband;			/**< Largest change of the constant force value that is not sent */
+	uint32_t ff_min_resend_ms;		/**< Minimum time between two constant force commands */
+} rotation_manager_config_t;
+
+/**
+ * @brief Rotation manager state.
+ *
+ * The PID output is computed at every update, but it is sent to the wheel only
+ * every `ff_divider` updates. The divider doubles while the URB link is
+ * congested and goes back down by one per update once the link is free.
+ *
+ * A new value is sent only if it differs from the last one sent by more than
+ * the deadband and at least `ff_min_resend_ms` after it, or if a command may
+ * have been lost by the URB sender. The constant effect is played once after
+ * each wheel configuration, then it is only uploaded again. It counts as
+ * playing only once the play transfer has completed, and is played again
+ * after any lost packet or refused command.
+ */
 typedef struct {
+	const rotation_manager_config_t *config;
 	pid_t *pid;
 	urb_sender_t *urb_sender;
+	uint8_t ff_divider;				/**< Updates between two force feedback commands */
+	uint8_t ff_skip_cnt;			/**< Updates since the last force feedback command */
+	int16_t last_ff_value;			/**< Last constant force value submitted */
+	uint32_t last_ff_tick;			/**< Tick of the last constant force command */
+	bool8u ff_playing;				/**< CD_TRUE once the play command has completed */
+	bool8u ff_play_pending;			/**< CD_TRUE while the play command is queued or in flight */
+	uint32_t ff_play_done_cnt;		/**< Play commands completed at the last check */
+	bool8u ff_resend;				/**< CD_TRUE if the last value must be sent again */
+	uint32_t ff_loss_cnt;			/**< Packets expired or dropped by the URB sender at the last check */
+	uint32_t rate_window_start;		/**< Tick at which the completion rate window started */
+	uint32_t rate_window_sent_cnt;	/**< URBs completed before the window started */
+	uint32_t urb_done_rate;			/**< URBs completed per second on the last window */
+	uint32_t ff_skipped_cnt;		/**< Updates without force feedback command */
+	uint32_t ff_enqueue_fail_cnt;	/**< Force feedback commands the URB sender could not accept */
 } rotation_manager_t;
 
 Rotation_Manager_StatusTypeDef rotation_manager_init(
-		rotation_manager_t *rotation_manager, pid_t *pid,urb_sender_t *urb_sender);
+		rotation_manager_t *rotation_manager,
+		const rotation_manager_config_t *config, pid_t *pid,urb_sender_t *urb_sender);
+
+/**
+ * @brief Forgets the force feedback state of the wheel.
+ *
+ * To be called after each configuration of the wheel, so that the constant
+ * effect is uploaded and played again at the next update.
+ */
+Rotation_Manager_StatusTypeDef rotation_manager_reset_ff(
+		rotation_manager_t *rotation_manager);
 
+/**
+ * @brief Runs the steering regulator and sends its output to the wheel.
+ *
+ * A force feedback command that cannot be queued only slows down the next
+ * ones: ROTATION_MANAGER_ERROR is returned on a regulator error only.
+ */
 Rotation_Manager_StatusTypeDef rotation_manager_update(
-		rotation_manager_t *rotation_manager, double auto_steer_feedback,
-		double auto_control_steer);
+		rotation_manager_t *rotation_manager, float auto_steer_feedback,
+		float auto_control_steer);
 
 #endif /* INC_ROTATION_MANAGER_H_ */
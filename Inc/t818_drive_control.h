@@ -95,6 +95,7 @@ typedef struct {
     const t818_drive_control_config_t *config; /**< Pointer to the configuration structure */
     t818_driving_commands_t t818_driving_commands; /**< Current driving commands */
     t818_drive_control_state state; /**< current drive control state */
+    bool8u input_settled; /**< CD_TRUE once the commands reflect an unchanged report and no button is pressed */
 } t818_drive_control_t;
 
 /* Defines ------------------------------------------------------------------*/
@@ -145,8 +146,13 @@ T818DriveControl_StatusTypeDef t818_drive_control_init(
  * `t818_drive_control_t` instance.
  *
  * @param t818_drive_control Pointer to the drive control instance.
+ * @param urb_sender Pointer to the URB sender of the force feedback packets.
+ * @param rotation_manager Pointer to the rotation manager of the wheel.
+ * @param steer_feedback Steer of the vehicle, followed by the wheel in autonomous driving.
+ * @param steer_feedback_valid CD_FALSE if the steer feedback cannot be trusted: the
+ *        wheel is then left where it is instead of being driven toward it.
  * @return T818_DC_OK if the step was executed successfully, otherwise T818_DC_ERROR.
  */
-T818DriveControl_StatusTypeDef t818_drive_control_step(t818_drive_control_t *t818_drive_control, urb_sender_t *urb_sender, rotation_manager_t* rotation_manager,int16_t steer_feedback);
+T818DriveControl_StatusTypeDef t818_drive_control_step(t818_drive_control_t *t818_drive_control, urb_sender_t *urb_sender, rotation_manager_t* rotation_manager,int16_t steer_feedback, bool8u steer_feedback_valid);
 
 #endif /* INC_T818_DRIVE_CONTROL_H_ */
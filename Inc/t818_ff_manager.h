@@ -36,6 +36,14 @@ typedef uint8_t T818_FF_Manager_StatusTypeDef;
 #define T818_FF_MANAGER_MAX_CONSTANT_VALUE						((int16_t) 16381)
 #define T818_FF_MANAGER_MIN_CONSTANT_VALUE						((int16_t)-16385)
 
+/** @brief Coalescing key of the constant force upload packets. */
+#define T818_FF_MANAGER_COSTANT_UPLOAD_KEY						((uint8_t) 1U)
+/** @brief Coalescing key of the constant force play packets, also used to track their completion. */
+#define T818_FF_MANAGER_COSTANT_PLAY_KEY						((uint8_t) 2U)
+
+/** @brief Time after which a queued constant force upload is dropped instead of sent. */
+#define T818_FF_MANAGER_COSTANT_LIFETIME_MS						(20U)
+
 
 /**
  * @brief Initializes the force feedback manager.
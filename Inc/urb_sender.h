@@ -5,6 +5,40 @@
  * This file contains the type definitions and function prototypes for the URB Sender module,
  * which is responsible for managing USB requests and ensuring proper communication via USB.
  *
+ * Packets live in a static pool owned by the sender. A producer allocates a slot,
+ * builds the packet in place and submits it: submitting only marks the slot as queued
+ * and stamps it with a sequence number, and the URB is sent straight from the slot,
+ * which is given back to the pool once the transfer has completed.
+ *
+ * URB state is tracked per pipe. Each step sends, for every idle pipe, the oldest
+ * queued packet addressed to it, so a packet waiting for a busy pipe never blocks
+ * packets for the other pipes.
+ *
+ * A packet may carry a coalescing key. When a packet is submitted while an older one
+ * with the same key is still queued, the new slot takes the place of the older one,
+ * with its position and lane, and the older one is released, so only the freshest
+ * command is sent and the queue depth stays bounded.
+ *
+ * Packets are submitted to one of two lanes with strict priority between them: the
+ * background lane is only served on the pipes without real-time packets, so that time
+ * critical force feedback updates never wait behind traffic that can be late. Packets
+ * that must reach the device in order, such as its configuration and the effects
+ * relying on it, go to the same lane. A packet may also carry an expiry tick, a packet
+ * still queued past its deadline is dropped instead of being sent.
+ *
+ * The outcome of each transfer is checked when it completes. A transfer ended by a
+ * NAK or by a transaction error is retried up to URB_SENDER_MAX_RETRIES times before
+ * its packet is dropped, a stalled one is dropped at once. A packet the host cannot
+ * take is left at the head of its pipe and sent at the next step. Counters of the sent,
+ * retried and dropped packets, the queue high-water mark and a histogram of the time
+ * from submission to URB done can be read with `urb_sender_get_stats()`.
+ *
+ * Transmission is event driven: the task running `urb_sender_dequeue_msg()` blocks in
+ * `urb_sender_wait_event()` and is woken by a task notification when a packet is
+ * submitted or when the USB host reports a URB state change through
+ * `urb_sender_notify_from_isr()`, so that the next packet goes out as soon as the
+ * previous transfer on its pipe is done.
+ *
  * Created on: Jul 9, 2024
  * Authors: Alessio Guarini, Antonio Vitale
  */
@@ -29,6 +63,45 @@ typedef uint8_t URBSender_StatusTypeDef;
 /* Defines ------------------------------------------------------------------*/
 #define URB_MESSAGE_DIM                         (64U)
 
+/** @brief Number of packet slots in the pool, at most 32 */
+#define URB_SENDER_POOL_SIZE                    (16U)
+
+/** @brief Slot index meaning no packet */
+#define URB_SENDER_NO_PACKET                    ((uint8_t) 0xFFU)
+
+/** @brief Number of coalescing keys, key 0 is URB_SENDER_NO_KEY */
+#define URB_SENDER_COALESCE_KEYS                (4U)
+
+/** @brief Coalescing key of a packet never merged with others */
+#define URB_SENDER_NO_KEY                       ((uint8_t) 0U)
+
+/** @brief Lane of the time critical packets, always served first */
+#define URB_SENDER_LANE_REALTIME                ((uint8_t) 0U)
+
+/** @brief Lane of the packets no control step waits for, such as the spring upload; configuration and gain use the real-time lane */
+#define URB_SENDER_LANE_BACKGROUND              ((uint8_t) 1U)
+
+/** @brief Number of lanes, in decreasing order of priority */
+#define URB_SENDER_LANE_COUNT                   (2U)
+
+/** @brief Number of pipes tracked by the sender, pipe numbers must be lower */
+#define URB_SENDER_MAX_PIPES                    (16U)
+
+/** @brief Number of times a transfer ended by a NAK or an error is sent again */
+#define URB_SENDER_MAX_RETRIES                  (3U)
+
+/**
+ * @brief Number of bins of the submission to URB done latency histogram.
+ *
+ * Bin 0 counts latencies below 1 ms, bin n counts latencies in [2^(n-1), 2^n) ms,
+ * the last bin also counts every longer latency.
+ */
+#define URB_SENDER_LATENCY_BINS                 (8U)
+
+#if (URB_SENDER_POOL_SIZE > 32U)
+#error "URB_SENDER_POOL_SIZE must fit in the 32-bit free slot mask"
+#endif
+
 /** @brief Macro indicating successful operation */
 #define URB_SENDER_OK                           ((URBSender_StatusTypeDef) 0U)
 
@@ -36,12 +109,36 @@ typedef uint8_t URBSender_StatusTypeDef;
 #define URB_SENDER_ERROR                        ((URBSender_StatusTypeDef) 1U)
 
 /**
- * @brief Structure representing an interrupt message for URB transmission.
+ * @brief Structure representing an interrupt packet for URB transmission.
  */
 typedef struct {
     uint8_t msg[URB_MESSAGE_DIM]; /**< Message buffer */
+    uint8_t length; /**< Number of bytes of the message to be sent */
     uint8_t pipe_num; /**< Pipe number for the USB transfer */
-} urb_interr_msg_t;
+    uint8_t coalesce_key; /**< Coalescing key, URB_SENDER_NO_KEY to always enqueue */
+    uint8_t lane; /**< Lane the packet is submitted to */
+    bool8u expires; /**< CD_TRUE if the packet is dropped once expiry_tick has passed */
+    uint32_t expiry_tick; /**< Last tick at which the packet may still be sent */
+    uint32_t seq; /**< Submission order, set by the sender */
+    uint32_t submit_tick; /**< Tick of the last submission, set by the sender */
+    uint8_t retry_cnt; /**< Number of times the packet was sent again, set by the sender */
+    const void *image; /**< Identifies the content of msg for the producer, kept while the slot is free */
+} urb_packet_t;
+
+/**
+ * @brief Runtime statistics of the URB Sender.
+ */
+typedef struct {
+    uint32_t sent_cnt; /**< Number of transfers completed with URB done */
+    uint32_t retried_cnt; /**< Number of transfers sent again after a NAK or an error */
+    uint32_t dropped_cnt; /**< Number of packets given up after a stall or too many retries */
+    uint32_t coalesced_cnt; /**< Number of packets merged into a queued one */
+    uint32_t expired_cnt; /**< Number of packets dropped past their expiry tick */
+    uint32_t deferred_cnt; /**< Number of submissions refused by the host and left for the next step */
+    uint32_t done_by_key_cnt[URB_SENDER_COALESCE_KEYS]; /**< Transfers completed with URB done, per coalescing key */
+    uint8_t queue_hwm; /**< Highest number of packets queued at once */
+    uint32_t latency_hist[URB_SENDER_LATENCY_BINS]; /**< Time from submission to URB done */
+} urb_sender_stats_t;
 
 /**
  * @brief Configuration structure for URB Sender.
@@ -55,8 +152,14 @@ typedef struct {
  */
 typedef struct {
     const urb_sender_config_t *config; /**< Pointer to the URB sender configuration */
-    osMessageQId xQueue; /**< Handle to the message queue */
-    urb_interr_msg_t interr_buff; /**< Interrupt buffer for message handling */
+    urb_packet_t pool[URB_SENDER_POOL_SIZE]; /**< Packet slots */
+    uint32_t free_mask; /**< One bit per free slot */
+    uint32_t queued_mask[URB_SENDER_LANE_COUNT]; /**< One bit per slot waiting to be sent, per lane */
+    uint32_t next_seq; /**< Sequence number of the next submitted packet */
+    uint8_t in_flight[URB_SENDER_MAX_PIPES]; /**< Slot of the URB being transferred on each pipe, or URB_SENDER_NO_PACKET */
+    uint8_t queued_by_key[URB_SENDER_COALESCE_KEYS]; /**< Queued slot holding each key, or URB_SENDER_NO_PACKET */
+    urb_sender_stats_t stats; /**< Runtime statistics */
+    TaskHandle_t tx_task; /**< Task waiting for URB events, NULL until it first waits */
 } urb_sender_t;
 
 /* Function Prototypes ------------------------------------------------------*/
@@ -68,31 +171,101 @@ typedef struct {
  *
  * @param[in] urb_sender Pointer to the URB sender structure.
  * @param[in] config Pointer to the URB sender configuration structure.
- * @param[in] xQueue Handle to the message queue.
  * @return Status of the initialization.
  */
-URBSender_StatusTypeDef urb_sender_init(urb_sender_t *urb_sender, const urb_sender_config_t *config, osMessageQId xQueue);
+URBSender_StatusTypeDef urb_sender_init(urb_sender_t *urb_sender, const urb_sender_config_t *config);
+
+/**
+ * @brief Allocates a packet slot from the pool.
+ *
+ * The slot must then be either submitted or released.
+ *
+ * @param[in] urb_sender Pointer to the URB sender structure.
+ * @return Pointer to the slot, NULL if the pool is exhausted.
+ */
+urb_packet_t *urb_sender_alloc_packet(urb_sender_t *urb_sender);
+
+/**
+ * @brief Gives an allocated packet slot back to the pool without sending it.
+ *
+ * @param[in] urb_sender Pointer to the URB sender structure.
+ * @param[in] packet Pointer to the slot.
+ * @return Status of the operation.
+ */
+URBSender_StatusTypeDef urb_sender_release_packet(urb_sender_t *urb_sender, urb_packet_t *packet);
 
 /**
- * @brief Enqueues a message to the URB sender.
+ * @brief Submits a packet built in an allocated slot.
  *
- * This function enqueues an interrupt message to the URB sender's message queue.
+ * The slot is queued in the lane of the packet. If a queued packet has the
+ * same coalescing key, this slot takes its place in the queue, with its lane
+ * and sequence number, and the queued slot is released. The slot is also
+ * released on failure.
  *
  * @param[in] urb_sender Pointer to the URB sender structure.
- * @param[in] interr_msg Pointer to the interrupt message structure.
+ * @param[in] packet Pointer to the slot.
  * @return Status of the enqueue operation.
  */
-URBSender_StatusTypeDef urb_sender_enqueue_msg(urb_sender_t *urb_sender, const urb_interr_msg_t *interr_msg);
+URBSender_StatusTypeDef urb_sender_submit_packet(urb_sender_t *urb_sender, urb_packet_t *packet);
 
 /**
  * @brief Dequeues and processes a message from the URB sender.
  *
- * This function dequeues an interrupt message from the URB sender's message queue
- * and sends the data via USB if the wheel is linked and the USB transfer is idle.
+ * This function checks the outcome of the completed URBs, queues again the
+ * packets to be retried and gives the other slots back to the pool, then,
+ * for every idle pipe, sends the oldest queued packet addressed to it straight
+ * from its slot, from the real-time lane first, if the wheel is linked.
+ * Expired packets are dropped on the way. While the wheel is not linked, every
+ * queued or in-flight packet is dropped. A packet the host refuses stays at
+ * the head of its pipe and the pipe is not served again before the next call.
+ * It is meant to be called after each return of urb_sender_wait_event().
  *
  * @param[in] urb_sender Pointer to the URB sender structure.
  * @return Status of the dequeue and send operation.
  */
 URBSender_StatusTypeDef urb_sender_dequeue_msg(urb_sender_t *urb_sender);
 
+/**
+ * @brief Waits for the next URB event.
+ *
+ * The calling task becomes the one notified by the sender. It is woken when a
+ * packet is submitted, when a URB changes state or when the timeout elapses,
+ * so that a lost notification only delays the transmission.
+ *
+ * @param[in] urb_sender Pointer to the URB sender structure.
+ * @param[in] timeout Maximum time to wait, in ticks.
+ * @return Status of the operation.
+ */
+URBSender_StatusTypeDef urb_sender_wait_event(urb_sender_t *urb_sender, TickType_t timeout);
+
+/**
+ * @brief Notifies a URB state change from interrupt context.
+ *
+ * Meant to be called from HAL_HCD_HC_NotifyURBChange_Callback, the channel
+ * number being the pipe number.
+ *
+ * @param[in] urb_sender Pointer to the URB sender structure.
+ * @param[in] pipe_num Pipe whose URB changed state.
+ */
+void urb_sender_notify_from_isr(urb_sender_t *urb_sender, uint8_t pipe_num);
+
+/**
+ * @brief Copies the runtime statistics.
+ *
+ * @param[in] urb_sender Pointer to the URB sender structure.
+ * @param[out] stats Pointer where the statistics are copied.
+ * @return Status of the operation.
+ */
+URBSender_StatusTypeDef urb_sender_get_stats(const urb_sender_t *urb_sender, urb_sender_stats_t *stats);
+
+/**
+ * @brief Returns the number of packets not yet completed.
+ *
+ * Both the queued packets and the ones being transferred are counted.
+ *
+ * @param[in] urb_sender Pointer to the URB sender structure.
+ * @return Number of pending packets, 0 if urb_sender is NULL.
+ */
+uint8_t urb_sender_get_pending_count(const urb_sender_t *urb_sender);
+
 #endif /* INC_URB_SENDER_H_ */
@@ -57,6 +57,15 @@ extern "C" {
 #define HID_MAX_NBR_REPORT_FMT                      8U
 #define HID_QUEUE_SIZE                              8U
 
+/* Number of report slots of a report ring, must be a power of two */
+#define HID_REPORT_RING_SIZE                        HID_QUEUE_SIZE
+/* Number of report slots used in latest report mode */
+#define HID_REPORT_LATEST_SLOTS                     3U
+
+#if ((HID_REPORT_RING_SIZE & (HID_REPORT_RING_SIZE - 1U)) != 0U)
+#error "HID_REPORT_RING_SIZE must be a power of two"
+#endif
+
 #define  HID_ITEM_LONG                              0xFEU
 
 #define  HID_ITEM_TYPE_MAIN                         0x00U
@@ -205,6 +214,25 @@ typedef struct
 } FIFO_TypeDef;
 
 
+/* Single producer / single consumer ring of whole reports.
+   In queue mode the reader gets the reports in order and a report arriving
+   when every slot is full is dropped. In latest report mode the slots form a
+   triple buffer and the reader always gets the newest complete report. */
+typedef struct
+{
+  uint8_t  *slots;
+  uint16_t  slot_size;
+  uint16_t  length[HID_REPORT_RING_SIZE];
+  uint8_t   latest_only;
+  uint32_t  head;
+  uint32_t  tail;
+  uint8_t   write_slot;
+  uint8_t   read_slot;
+  uint8_t   latest_slot;
+  uint32_t  overrun_cnt;
+} HID_ReportRingTypeDef;
+
+
 /* Structure for HID process */
 typedef struct _HID_Process
 {
@@ -215,12 +243,14 @@ typedef struct _HID_Process
   uint8_t              InEp;
   HID_CtlStateTypeDef  ctl_state;
   FIFO_TypeDef         fifo;
+  HID_ReportRingTypeDef report_ring;
   uint8_t              *pData;
   uint16_t             length;
   uint8_t              ep_addr;
   uint16_t             poll;
   uint32_t             timer;
   uint8_t              DataReady;
+  uint8_t              InEventCallback;  /* Set while USBH_HID_EventCallback() runs */
   HID_DescTypeDef      HID_Desc;
   USBH_StatusTypeDef(* Init)(USBH_HandleTypeDef *phost);
 }
@@ -315,6 +345,13 @@ uint16_t  USBH_HID_FifoRead(FIFO_TypeDef *f, void *buf, uint16_t  nbytes);
 
 uint16_t  USBH_HID_FifoWrite(FIFO_TypeDef *f, void *buf, uint16_t nbytes);
 
+void USBH_HID_ReportRingInit(HID_ReportRingTypeDef *r, uint8_t *buf,
+                             uint16_t slot_size, uint8_t latest_only);
+
+uint16_t USBH_HID_ReportRingRead(HID_ReportRingTypeDef *r, void *buf, uint16_t nbytes);
+
+uint16_t USBH_HID_ReportRingWrite(HID_ReportRingTypeDef *r, const void *buf, uint16_t nbytes);
+
 /**
   * @}
   */
@@ -66,8 +66,62 @@ typedef struct
 HID_Report_ItemTypedef;
 
 
+/** @brief Maximum number of fields extracted from a report */
+#define HID_EXTRACT_MAX_STEPS          48U
+
+/** @brief Maximum number of usages listed before a main item */
+#define HID_PARSER_MAX_USAGES          16U
+
+/** @brief Depth of the global item stack (Push/Pop) */
+#define HID_PARSER_STACK_DEPTH         2U
+
+/** @brief Builds an extended usage from its usage page and usage ID */
+#define HID_EXTENDED_USAGE(page, id)   ((((uint32_t)(page)) << 16) | ((uint32_t)(id) & 0xFFFFU))
+
+/**
+  * @brief Destination of a usage in the decoded device structure.
+  */
+typedef struct
+{
+  uint32_t usage;       /*extended usage, see HID_EXTENDED_USAGE*/
+  uint8_t  dest_offset; /*byte offset of the destination field*/
+  uint8_t  dest_size;   /*size of the destination field, 1 or 2 bytes*/
+  uint16_t max;         /*values above are clamped*/
+}
+HID_Usage_MapTypedef;
+
+/**
+  * @brief One field extraction, 8 bytes.
+  */
+typedef struct
+{
+  uint8_t  byte_offset; /*first report byte holding the field*/
+  uint8_t  shift;       /*position of the field LSB in that byte*/
+  uint8_t  dest_offset; /*byte offset of the destination field*/
+  uint8_t  dest_size;   /*size of the destination field, 1 or 2 bytes*/
+  uint16_t mask;        /*mask of the field once shifted*/
+  uint16_t max;         /*values above are clamped*/
+}
+HID_Extract_StepTypedef;
+
+/**
+  * @brief Flattened extraction plan of an input report.
+  */
+typedef struct
+{
+  HID_Extract_StepTypedef steps[HID_EXTRACT_MAX_STEPS];
+  uint8_t count;        /*number of steps, 0 if the plan is not usable*/
+  uint8_t report_id;    /*report ID, 0 if the device does not use report IDs*/
+}
+HID_Extract_PlanTypedef;
+
+
 uint32_t HID_ReadItem(HID_Report_ItemTypedef *ri, uint8_t ndx);
 uint32_t HID_WriteItem(HID_Report_ItemTypedef *ri, uint32_t value, uint8_t ndx);
+USBH_StatusTypeDef HID_CompileReportDesc(const uint8_t *desc, uint16_t length,
+                                         const HID_Usage_MapTypedef *map, uint8_t map_count,
+                                         uint16_t report_length, HID_Extract_PlanTypedef *plan);
+uint8_t HID_ExtractReport(const HID_Extract_PlanTypedef *plan, const uint8_t *report, uint8_t *dest);
 
 
 /**
@@ -45,6 +45,16 @@ extern "C" {
  */
 #define T818_REPORT_SIZE (64U)
 
+/** @def T818_REPORT_LATEST_ONLY
+ *  @brief 1 to decode only the newest report received, 0 to decode every report in order.
+ */
+#define T818_REPORT_LATEST_ONLY (0U)
+
+/** @def T818_AXIS_AVERAGE
+ *  @brief 1 to average the axes over the reports read in a step, 0 to take the last values.
+ */
+#define T818_AXIS_AVERAGE (0U)
+
 /** @def BUTTON_COUNT
  *  @brief Number of buttons on the T818 device.
  */
@@ -290,16 +300,17 @@ extern "C" {
   */
 typedef struct _HID_T818_Info {
     uint16_t wheel_rotation; /**< X axis rotation of the wheel */
-    uint16_t brake:10;       /**< Y axis value for brake */
-    uint16_t throttle:10;    /**< Rz axis value for throttle */
-    uint16_t clutch:10;      /**< Slider axis value for clutch */
+    uint16_t brake;          /**< Y axis value for brake */
+    uint16_t throttle;       /**< Rz axis value for throttle */
+    uint16_t clutch;         /**< Slider axis value for clutch */
     uint8_t vx_axis;         /**< Vx axis, not mapped */
     uint8_t vy_axis;         /**< Vy axis, not mapped */
     uint8_t rx_axis;         /**< Rx axis value */
     uint8_t ry_axis;         /**< Ry axis value */
     uint8_t z_axis;          /**< Z axis, not mapped */
     uint8_t buttons[BUTTON_COUNT]; /**< Array of button states */
-    uint8_t pad_arrow:4;     /**< D-pad arrow state */
+    uint8_t pad_arrow;       /**< D-pad arrow state */
+    uint8_t changed;         /**< Set to 1 when a report with new values is decoded, cleared by the reader */
 } HID_T818_Info_TypeDef;
 
 /**
@@ -337,8 +348,15 @@ extern USBH_StatusTypeDef USBH_HID_T818Init(USBH_HandleTypeDef *phost);
 
 /**
   * @brief  Get the T818 HID Information.
+  *         Reads every report received since the last call and reduces them
+  *         into the T818 information, latching the button presses and releases.
+  *         Meant to be called once per control step, by the control task only:
+  *         t818_drive_control_step() already calls it, so the application must
+  *         not call it as well, in particular not from USBH_HID_EventCallback(),
+  *         and should read USBH_HID_T818GetInstance() instead.
   * @param  phost: Host handle
-  * @retval USBH Status
+  * @retval USBH Status, USBH_FAIL if no new report was received, USBH_BUSY
+  *         without reading any report if called from USBH_HID_EventCallback()
   */
 USBH_StatusTypeDef USBH_HID_GetT818Info(USBH_HandleTypeDef *phost);
 
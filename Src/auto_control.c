@@ -13,6 +13,10 @@
 
 #include "auto_control.h"
 
+/** @brief Slope of the wheel angle to steering command mapping */
+#define AUTO_CONTROL_STEERING_SCALE MAP_VALUE_SCALE(T818_MIN_STEERING_ANGLE, \
+		T818_MAX_STEERING_ANGLE, AUTO_CONTROL_MIN_STEERING, AUTO_CONTROL_MAX_STEERING)
+
 /**
  * @brief Checks if parking is enabled based on speed command.
  *
@@ -174,10 +178,10 @@ static inline void __basic_rules(auto_control_t *auto_control) {
 	auto_data->mode_selection = AUTO_CONTROL_MODE_SELECTION_FIELD;
 
 	auto_data->steering = (int16_t) roundf(
-			map_value_float(drive_comm->wheel_steering_degree,
+			map_value_float_scaled(drive_comm->wheel_steering_degree,
 			T818_MIN_STEERING_ANGLE,
 			T818_MAX_STEERING_ANGLE, AUTO_CONTROL_MIN_STEERING,
-			AUTO_CONTROL_MAX_STEERING));
+			AUTO_CONTROL_STEERING_SCALE));
 }
 
 /*
@@ -378,3 +382,16 @@ AutoControl_StatusTypeDef auto_control_step(auto_control_t *auto_control) {
 
 	return status;
 }
+
+AutoControl_StatusTypeDef auto_control_safe_state(auto_control_t *auto_control) {
+	AutoControl_StatusTypeDef status = AUTO_CONTROL_ERROR;
+
+	if (auto_control != NULL) {
+		auto_control->auto_control_data.speed = AUTO_CONTROL_MIN_SPEED;
+		auto_control->auto_control_data.braking = AUTO_CONTROL_MAX_BRAKING;
+		auto_control->auto_control_data.EBP = CD_TRUE;
+		status = AUTO_CONTROL_OK;
+	}
+
+	return status;
+}
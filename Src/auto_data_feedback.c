@@ -7,6 +7,32 @@
 
 #include "auto_data_feedback.h"
 
+/**
+ * @brief Extrapolates a signal linearly from its last two receptions.
+ *
+ * @param prev Value of the previous reception.
+ * @param last Value of the last reception.
+ * @param interval_ms Time between the two receptions.
+ * @param age_ms Time elapsed since the last reception, already limited to the horizon.
+ * @param min Minimum value of the signal.
+ * @param max Maximum value of the signal.
+ * @return The extrapolated value.
+ */
+static inline int16_t __extrapolate(int16_t prev, int16_t last, uint32_t interval_ms,
+		uint32_t age_ms, int32_t min, int32_t max) {
+	int32_t value = (int32_t) last;
+
+	if (interval_ms > 0U) {
+		value += (((int32_t) last - (int32_t) prev) * (int32_t) age_ms) / (int32_t) interval_ms;
+	}
+	if (value < min) {
+		value = min;
+	} else if (value > max) {
+		value = max;
+	}
+	return (int16_t) value;
+}
+
 
 AutoDataFeedback_StatusTypeDef auto_data_feedback_init(
 		auto_data_feedback_t *auto_data_feedback) {
@@ -31,3 +57,121 @@ AutoDataFeedback_StatusTypeDef auto_data_feedback_init(
 	}
 	return status;
 }
+
+AutoDataFeedback_StatusTypeDef auto_data_feedback_tracker_init(
+		auto_data_feedback_tracker_t *tracker,
+		const auto_data_feedback_freshness_config_t *config) {
+	AutoDataFeedback_StatusTypeDef status = AUTO_DATA_FEEDBACK_ERROR;
+
+	if ((tracker != NULL) && (config != NULL)) {
+		tracker->config = config;
+		for (uint8_t i = 0U; i < (uint8_t) AUTO_DATA_FEEDBACK_SIGNAL_COUNT; i++) {
+			tracker->rx_tick[i] = 0U;
+			tracker->rx_valid[i] = CD_FALSE;
+		}
+		tracker->prev_speed = AUTO_DATA_FEEDBACK_SPEED_ZERO;
+		tracker->prev_steer = AUTO_DATA_FEEDBACK_STEER_ZERO;
+		tracker->prev_rx_tick = 0U;
+		tracker->prev_valid = CD_FALSE;
+		tracker->stale_cnt = 0U;
+		tracker->safe_state = CD_FALSE;
+		status = auto_data_feedback_init(&tracker->received);
+	}
+	return status;
+}
+
+AutoDataFeedback_StatusTypeDef auto_data_feedback_tracker_update(
+		auto_data_feedback_tracker_t *tracker,
+		const auto_data_feedback_t *received, uint32_t rx_tick) {
+	AutoDataFeedback_StatusTypeDef status = AUTO_DATA_FEEDBACK_ERROR;
+
+	if ((tracker != NULL) && (received != NULL)) {
+		/* Speed and steer travel in the same frame, one tick describes both */
+		tracker->prev_valid = tracker->rx_valid[AUTO_DATA_FEEDBACK_SIGNAL_speed];
+		tracker->prev_speed = tracker->received.speed;
+		tracker->prev_steer = tracker->received.steer;
+		tracker->prev_rx_tick = tracker->rx_tick[AUTO_DATA_FEEDBACK_SIGNAL_speed];
+
+		tracker->received = *received;
+		for (uint8_t i = 0U; i < (uint8_t) AUTO_DATA_FEEDBACK_SIGNAL_COUNT; i++) {
+			tracker->rx_tick[i] = rx_tick;
+			tracker->rx_valid[i] = CD_TRUE;
+		}
+		status = AUTO_DATA_FEEDBACK_OK;
+	}
+	return status;
+}
+
+uint32_t auto_data_feedback_get_age(const auto_data_feedback_tracker_t *tracker,
+		auto_data_feedback_signal_t signal, uint32_t now) {
+	uint32_t age = AUTO_DATA_FEEDBACK_AGE_NEVER;
+
+	if ((tracker != NULL) && (signal < AUTO_DATA_FEEDBACK_SIGNAL_COUNT)
+			&& (tracker->rx_valid[signal] == CD_TRUE)) {
+		age = now - tracker->rx_tick[signal];
+	}
+	return age;
+}
+
+bool8u auto_data_feedback_is_stale(const auto_data_feedback_tracker_t *tracker,
+		auto_data_feedback_signal_t signal, uint32_t now) {
+	bool8u stale = CD_TRUE;
+
+	if ((tracker != NULL)
+			&& (auto_data_feedback_get_age(tracker, signal, now) <= tracker->config->max_age_ms)) {
+		stale = CD_FALSE;
+	}
+	return stale;
+}
+
+AutoDataFeedback_StatusTypeDef auto_data_feedback_tracker_apply(
+		auto_data_feedback_tracker_t *tracker, uint32_t now,
+		auto_data_feedback_t *auto_data_feedback) {
+	AutoDataFeedback_StatusTypeDef status = AUTO_DATA_FEEDBACK_ERROR;
+
+	if ((tracker != NULL) && (auto_data_feedback != NULL)) {
+		const auto_data_feedback_freshness_config_t *config = tracker->config;
+		*auto_data_feedback = tracker->received;
+		tracker->safe_state = CD_FALSE;
+
+		/* All the signals share the feedback frame, so they age together */
+		if (auto_data_feedback_is_stale(tracker, AUTO_DATA_FEEDBACK_SIGNAL_speed, now) == CD_TRUE) {
+			(tracker->stale_cnt)++;
+
+			switch (config->stale_policy) {
+			case AUTO_DATA_FEEDBACK_STALE_EXTRAPOLATE:
+				if (tracker->prev_valid == CD_TRUE) {
+					uint32_t age = auto_data_feedback_get_age(tracker, AUTO_DATA_FEEDBACK_SIGNAL_speed, now);
+					const uint32_t interval = tracker->rx_tick[AUTO_DATA_FEEDBACK_SIGNAL_speed] - tracker->prev_rx_tick;
+
+					if (age > config->max_extrapolation_ms) {
+						age = config->max_extrapolation_ms;
+					}
+					auto_data_feedback->speed = __extrapolate(tracker->prev_speed, tracker->received.speed,
+							interval, age, AUTO_DATA_FEEDBACK_SPEED_MIN, AUTO_DATA_FEEDBACK_SPEED_MAX);
+					auto_data_feedback->steer = __extrapolate(tracker->prev_steer, tracker->received.steer,
+							interval, age, AUTO_DATA_FEEDBACK_STEER_MIN, AUTO_DATA_FEEDBACK_STEER_MAX);
+				}
+				break;
+			case AUTO_DATA_FEEDBACK_STALE_SAFE_STATE:
+				/* A chassis not heard from yet is booting, not lost: the defaults are held */
+				tracker->safe_state = tracker->rx_valid[AUTO_DATA_FEEDBACK_SIGNAL_speed];
+				break;
+			default:
+				/* AUTO_DATA_FEEDBACK_STALE_HOLD: the last received values are kept */
+				break;
+			}
+		}
+		status = AUTO_DATA_FEEDBACK_OK;
+	}
+	return status;
+}
+
+bool8u auto_data_feedback_is_safe_state(const auto_data_feedback_tracker_t *tracker) {
+	bool8u safe_state = CD_FALSE;
+
+	if (tracker != NULL) {
+		safe_state = tracker->safe_state;
+	}
+	return safe_state;
+}
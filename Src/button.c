@@ -17,7 +17,7 @@ Button_StatusTypeDef button_is_pressed_long(button_t *button) {
 		switch (button->long_pressed_state) {
 		case NOT_PRESSED:
 			if (button->actual_raw_state == BUTTON_PRESSED) {
-				button->start_pressing_time = HAL_GetTick();
+				button->start_pressing_time = CD_GET_TICK();
 				button->long_pressed_state = PRESSING;
 			}
 			status = BUTTON_OK;
@@ -25,7 +25,7 @@ Button_StatusTypeDef button_is_pressed_long(button_t *button) {
 		case PRESSING:
 			if (button->actual_raw_state == BUTTON_NOT_PRESSED) {
 				button->long_pressed_state = NOT_PRESSED;
-			} else if ((HAL_GetTick()
+			} else if ((CD_GET_TICK()
 					- button->start_pressing_time)>=BUTTON_LONG_PRESSING_WAITING_TIME) {
 				button->state = ((!button->state) & BUTTON_8BIT_MASK);
 				button->long_pressed_state = STATE_CHANGED;
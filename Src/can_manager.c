@@ -6,6 +6,14 @@
  * `can_manager.h` header file. It includes initialization and transmission
  * functionalities for CAN messages in a Pix Moving's vehicle.
  *
+ * The RX ring is published with acquire/release atomics: the interrupt fills a
+ * slot and then releases `head`, the consumer copies a slot and then releases
+ * `tail`, so neither side ever needs to mask interrupts.
+ *
+ * The TX state of a message is shared with the TX mailbox interrupts, so the
+ * task side only touches it inside short critical sections and never polls
+ * the peripheral.
+ *
  * Created on: Jun 26, 2024
  * Authors: Alessio Guarini, Antonio Vitale
  */
@@ -14,90 +22,615 @@
 
 #define MAX_CAN_OCCUPANCY_CNT						(3U)
 
+/**
+ * @brief Expands one message line of the signal database into its identifier and direction.
+ */
+#define __CAN_MESSAGE_ENTRY(name, id, dlc, type, direction) { (id), (direction) },
+
+/**
+ * @brief Expands one message line into its contribution to the count of RX messages.
+ */
+#define __CAN_RX_MESSAGE_COUNT(name, id, dlc, type, direction) + (((direction) == CAN_SIGNALS_RX) ? 1U : 0U)
+
+/**
+ * @brief Expands one message line into the check of its identifier width.
+ */
+#define __CAN_CHECK_STANDARD_ID(name, id, dlc, type, direction) \
+	_Static_assert((id) <= 0x7FFU, "CAN message " #name " needs a standard identifier");
+
+/**
+ * @brief Number of messages received by the DBW board.
+ */
+#define CAN_MANAGER_RX_MESSAGE_COUNT (0U CAN_SIGNALS_MESSAGES(__CAN_RX_MESSAGE_COUNT))
+
+CAN_SIGNALS_MESSAGES(__CAN_CHECK_STANDARD_ID)
+_Static_assert(CAN_MANAGER_RX_MESSAGE_COUNT > 0U, "No RX message to be accepted by the filters");
+_Static_assert(CAN_MANAGER_RX_MESSAGE_COUNT <= (CAN_MANAGER_SLAVE_START_FILTER_BANK * CAN_MANAGER_IDS_PER_FILTER_BANK),
+		"The RX messages do not fit in the CAN1 filter banks");
+
+/**
+ * @brief Messages of the signal database, the RX ones are the accepted identifiers.
+ */
+static const struct {
+	uint32_t id;
+	uint32_t direction;
+} can_messages[] = { CAN_SIGNALS_MESSAGES(__CAN_MESSAGE_ENTRY) };
+
+/**
+ * @brief CAN Manager instance served by the HAL callbacks.
+ */
+static can_manager_t *isr_instance = NULL;
+
+/**
+ * @brief Checks whether a tick has been reached, robust to the tick wrap-around.
+ *
+ * @param now Current tick.
+ * @param tick Tick to be checked.
+ * @return CD_TRUE if `now` is at or past `tick`, otherwise CD_FALSE.
+ */
+static inline bool8u __tick_reached(uint32_t now, uint32_t tick)
+{
+	return (((int32_t) (now - tick)) >= 0) ? CD_TRUE : CD_FALSE;
+}
+
+/**
+ * @brief Arbitration value of a TX header, lower values win the bus.
+ *
+ * @param header Pointer to the TX header.
+ * @return Identifier aligned on the 29-bit arbitration field.
+ */
+static inline uint32_t __arbitration_id(const CAN_TxHeaderTypeDef *header)
+{
+	return (header->IDE == CAN_ID_STD) ? (header->StdId << 18U) : header->ExtId;
+}
+
+/**
+ * @brief Sorts the TX message indexes by increasing identifier.
+ *
+ * @param can_manager Pointer to the CAN Manager instance.
+ */
+static void __sort_tx_order(can_manager_t *can_manager)
+{
+	const can_manager_config_t *config = can_manager->config;
+
+	for (uint8_t i = 0U; i < config->tx_message_count; i++) {
+		const uint32_t id = __arbitration_id(&config->tx_messages[i].tx_header);
+		uint8_t j = i;
+
+		while ((j > 0U) && (__arbitration_id(&config->tx_messages[can_manager->tx_order[j - 1U]].tx_header) > id)) {
+			can_manager->tx_order[j] = can_manager->tx_order[j - 1U];
+			j--;
+		}
+		can_manager->tx_order[j] = i;
+	}
+}
+
+/**
+ * @brief Programs one filter bank in 16-bit ID-list mode.
+ *
+ * @param can_manager Pointer to the CAN Manager instance.
+ * @param bank Filter bank to be programmed.
+ * @param ids Filter words of the four accepted identifiers.
+ * @return CAN_MANAGER_OK if the bank was programmed, otherwise CAN_MANAGER_ERROR.
+ */
+static CanManager_StatusTypeDef __config_rx_filter_bank(can_manager_t *can_manager, uint32_t bank,
+		const uint16_t *ids)
+{
+    CanManager_StatusTypeDef status = CAN_MANAGER_ERROR;
+    const CAN_FilterTypeDef filter = {
+        .FilterIdHigh = ids[0],
+        .FilterIdLow = ids[1],
+        .FilterMaskIdHigh = ids[2],
+        .FilterMaskIdLow = ids[3],
+        .FilterFIFOAssignment = can_manager->config->auto_data_feedback_rx_fifo,
+        .FilterBank = bank,
+        .FilterMode = CAN_FILTERMODE_IDLIST,
+        .FilterScale = CAN_FILTERSCALE_16BIT,
+        .FilterActivation = CAN_FILTER_ENABLE,
+        .SlaveStartFilterBank = CAN_MANAGER_SLAVE_START_FILTER_BANK
+    };
+
+    if (HAL_CAN_ConfigFilter(can_manager->config->hcan, &filter) == HAL_OK) {
+        status = CAN_MANAGER_OK;
+    }
+
+    return status;
+}
+
+/**
+ * @brief Programs the acceptance filters with the RX messages of the signal database.
+ *
+ * Identifiers are packed four per bank, the last bank is padded by repeating
+ * its last identifier.
+ *
+ * @param can_manager Pointer to the CAN Manager instance.
+ * @return CAN_MANAGER_OK if all the banks were programmed, otherwise CAN_MANAGER_ERROR.
+ */
+static CanManager_StatusTypeDef __config_rx_filters(can_manager_t *can_manager)
+{
+    CanManager_StatusTypeDef status = CAN_MANAGER_OK;
+    uint16_t ids[CAN_MANAGER_IDS_PER_FILTER_BANK];
+    uint32_t bank = can_manager->config->rx_filter_bank;
+    uint8_t id_cnt = 0U;
+
+    for (uint8_t i = 0U; (i < (sizeof(can_messages) / sizeof(can_messages[0]))) && (status == CAN_MANAGER_OK); i++) {
+        if (can_messages[i].direction == CAN_SIGNALS_RX) {
+            /* STDID[10:0] in the upper bits, RTR and IDE cleared: data frames with standard identifier */
+            ids[id_cnt] = (uint16_t) (can_messages[i].id << 5U);
+            id_cnt++;
+
+            if (id_cnt == CAN_MANAGER_IDS_PER_FILTER_BANK) {
+                status = __config_rx_filter_bank(can_manager, bank, ids);
+                bank++;
+                id_cnt = 0U;
+            }
+        }
+    }
+
+    if ((status == CAN_MANAGER_OK) && (id_cnt > 0U)) {
+        for (uint8_t i = id_cnt; i < CAN_MANAGER_IDS_PER_FILTER_BANK; i++) {
+            ids[i] = ids[id_cnt - 1U];
+        }
+        status = __config_rx_filter_bank(can_manager, bank, ids);
+    }
+
+    return status;
+}
+
 CanManager_StatusTypeDef can_manager_init(can_manager_t *can_manager, const can_manager_config_t *config) {
     CanManager_StatusTypeDef status = CAN_MANAGER_ERROR;
-    if ((can_manager != NULL) && (config != NULL) && (config->hcan != NULL)) {
+    if ((can_manager != NULL) && (config != NULL) && (config->hcan != NULL) &&
+        ((config->tx_messages != NULL) || (config->tx_message_count == 0U)) &&
+        (config->tx_message_count <= CAN_MANAGER_MAX_TX_MESSAGES) &&
+        (config->rx_filter_bank + ((CAN_MANAGER_RX_MESSAGE_COUNT + CAN_MANAGER_IDS_PER_FILTER_BANK - 1U) / CAN_MANAGER_IDS_PER_FILTER_BANK)
+                <= CAN_MANAGER_SLAVE_START_FILTER_BANK)) {
         can_manager->config = config;
-        can_manager->auto_control_tx_mailbox = 0U;
         can_manager->can_occupancy_cnt = 0U;
         can_manager->max_can_occupancy_cnt = 0U;
 
-        if ((memset(can_manager->tx_data, 0x00, CAN_MANAGER_TX_DATA_SIZE) == can_manager->tx_data) &&
-        	(memset(can_manager->rx_data, 0x00, CAN_MANAGER_RX_DATA_SIZE) == can_manager->rx_data) &&
-        	(HAL_CAN_Start(can_manager->config->hcan) == HAL_OK) &&
-            (HAL_CAN_ActivateNotification(can_manager->config->hcan, can_manager->config->auto_data_feedback_rx_interrupt) == HAL_OK)) {
-            status = CAN_MANAGER_OK;
+        status = CAN_MANAGER_OK;
+        const uint32_t now = CD_GET_TICK();
+        for (uint8_t i = 0U; i < config->tx_message_count; i++) {
+            can_manager_tx_slot_t *slot = &can_manager->tx_slots[i];
+            (void) memset(slot, 0x00, sizeof(*slot));
+            slot->next_release = now + config->tx_messages[i].phase_ms;
+            if (config->tx_messages[i].period_ms == 0U) {
+                status = CAN_MANAGER_ERROR;
+            }
+        }
+        for (uint8_t i = 0U; i < CAN_MANAGER_TX_MAILBOX_COUNT; i++) {
+            can_manager->tx_mailbox_owner[i] = CAN_MANAGER_TX_NO_OWNER;
+        }
+        can_manager->tx_abort_cnt = 0U;
+        (void) memset(&can_manager->stats, 0x00, sizeof(can_manager->stats));
+        can_manager->stats.window_start = now;
+        __sort_tx_order(can_manager);
+
+        can_manager->rx_ring.head = 0U;
+        can_manager->rx_ring.tail = 0U;
+        can_manager->rx_ring.overrun_cnt = 0U;
+        isr_instance = can_manager;
+
+        if ((status != CAN_MANAGER_OK) ||
+        	(__config_rx_filters(can_manager) != CAN_MANAGER_OK) ||
+        	(HAL_CAN_Start(can_manager->config->hcan) != HAL_OK) ||
+            (HAL_CAN_ActivateNotification(can_manager->config->hcan,
+                    can_manager->config->auto_data_feedback_rx_interrupt | CAN_IT_TX_MAILBOX_EMPTY |
+                    ((can_manager->config->auto_data_feedback_rx_fifo == CAN_RX_FIFO0) ?
+                            CAN_IT_RX_FIFO0_OVERRUN : CAN_IT_RX_FIFO1_OVERRUN)) != HAL_OK)) {
+            status = CAN_MANAGER_ERROR;
         }
     }
     return status;
 }
 
-CanManager_StatusTypeDef __add_message_to_mailbox(can_manager_t *can_manager, const uint8_t *can_data)
+/**
+ * @brief Worst case length of a standard data frame on the bus, in bits.
+ *
+ * 47 bits of framing, interframe space included, plus the payload, plus one
+ * stuff bit every four bits of the stuffed region.
+ *
+ * @param dlc Data length code of the frame.
+ * @return Length of the frame in bits.
+ */
+static inline uint32_t __frame_bits(uint32_t dlc)
 {
-    CanManager_StatusTypeDef status = CAN_MANAGER_ERROR;
-    const can_manager_config_t *config = (const can_manager_config_t*) can_manager->config;
-	uint32_t *pTxMailbox =  (uint32_t *) &can_manager->auto_control_tx_mailbox;
+	const uint32_t payload_bits = 8U * ((dlc > 8U) ? 8U : dlc);
+	return 47U + payload_bits + ((34U + payload_bits - 1U) / 4U);
+}
 
-	if (HAL_CAN_AddTxMessage(config->hcan, &(config->auto_control_tx_header), can_data, pTxMailbox) == HAL_OK) {
-		status = CAN_MANAGER_OK;
+/**
+ * @brief Records a TX latency in its histogram bin.
+ *
+ * @param stats Pointer to the statistics.
+ * @param latency_ms Latency in milliseconds.
+ */
+static inline void __record_tx_latency(can_manager_stats_t *stats, uint32_t latency_ms)
+{
+	uint8_t bin = 0U;
+	while ((latency_ms > 0U) && (bin < (CAN_MANAGER_TX_LATENCY_BINS - 1U))) {
+		latency_ms >>= 1U;
+		bin++;
 	}
+	(stats->tx_latency_hist[bin])++;
+}
+
+/**
+ * @brief Refreshes the error counters and closes the bus load window when due.
+ *
+ * @param can_manager Pointer to the CAN Manager instance.
+ * @param now Current tick in milliseconds.
+ */
+static void __update_stats(can_manager_t *can_manager, uint32_t now)
+{
+	can_manager_stats_t *stats = &can_manager->stats;
+	const uint32_t esr = can_manager->config->hcan->Instance->ESR;
+	const uint32_t elapsed_ms = now - stats->window_start;
+
+	stats->tec = (uint8_t) ((esr & CAN_ESR_TEC_Msk) >> CAN_ESR_TEC_Pos);
+	stats->rec = (uint8_t) ((esr & CAN_ESR_REC_Msk) >> CAN_ESR_REC_Pos);
+	stats->lec = (uint8_t) ((esr & CAN_ESR_LEC_Msk) >> CAN_ESR_LEC_Pos);
+	stats->error_flags = (uint8_t) (esr & (CAN_ESR_BOFF | CAN_ESR_EPVF | CAN_ESR_EWGF));
 
-	return status;
+	if ((elapsed_ms >= CAN_MANAGER_BUS_LOAD_WINDOW_MS) && (can_manager->config->bitrate > 0U)) {
+		CD_ENTER_CRITICAL();
+		const uint32_t bits = stats->window_bits;
+		stats->window_bits = 0U;
+		CD_EXIT_CRITICAL();
+
+		stats->bus_load_permille = (uint32_t) (((uint64_t) bits * 1000000U)
+				/ ((uint64_t) can_manager->config->bitrate * elapsed_ms));
+		stats->window_start = now;
+	}
+}
+
+/**
+ * @brief Converts a HAL TX mailbox into its index.
+ *
+ * @param mailbox HAL TX mailbox (CAN_TX_MAILBOX0, CAN_TX_MAILBOX1 or CAN_TX_MAILBOX2).
+ * @return Index of the mailbox.
+ */
+static inline uint8_t __mailbox_index(uint32_t mailbox)
+{
+	uint8_t index = 2U;
+	if (mailbox == CAN_TX_MAILBOX0) {
+		index = 0U;
+	} else if (mailbox == CAN_TX_MAILBOX1) {
+		index = 1U;
+	}
+	return index;
 }
 
-CanManager_StatusTypeDef __abort_message(can_manager_t *can_manager){
+/**
+ * @brief Counts a release finding the previous one not transmitted yet.
+ *
+ * @param can_manager Pointer to the CAN Manager instance.
+ */
+static inline void __count_occupancy(can_manager_t *can_manager)
+{
+	(can_manager->can_occupancy_cnt)++;
+	if (can_manager->can_occupancy_cnt > can_manager->max_can_occupancy_cnt) {
+		can_manager->max_can_occupancy_cnt = can_manager->can_occupancy_cnt;
+	}
+}
 
+/**
+ * @brief Submits the latest payload of a queued message to a free mailbox.
+ *
+ * Must be called with the TX interrupts masked or from a TX interrupt.
+ *
+ * @param can_manager Pointer to the CAN Manager instance.
+ * @param tx_index Index of the message in the TX message table.
+ * @return CAN_MANAGER_OK if the frame is now pending, otherwise CAN_MANAGER_ERROR.
+ */
+static CanManager_StatusTypeDef __submit_message(can_manager_t *can_manager, uint8_t tx_index)
+{
     CanManager_StatusTypeDef status = CAN_MANAGER_ERROR;
-    uint8_t abort_complete = CD_FALSE;
     const can_manager_config_t *config = (const can_manager_config_t*) can_manager->config;
+    can_manager_tx_slot_t *slot = &can_manager->tx_slots[tx_index];
+    uint32_t mailbox = 0U;
+
+    if ((HAL_CAN_GetTxMailboxesFreeLevel(config->hcan) > 0U) &&
+        (HAL_CAN_AddTxMessage(config->hcan, &(config->tx_messages[tx_index].tx_header), slot->data, &mailbox) == HAL_OK)) {
+        slot->mailbox = mailbox;
+        slot->submit_tick = CD_GET_TICK();
+        can_manager->tx_mailbox_owner[__mailbox_index(mailbox)] = tx_index;
+        slot->state = CAN_MANAGER_TX_PENDING;
+        status = CAN_MANAGER_OK;
+    }
 
-    HAL_CAN_AbortTxRequest(can_manager->config->hcan, can_manager->auto_control_tx_mailbox);
+    return status;
+}
 
-    static const uint32_t Timeout = 2U;
-    uint32_t stop_time = HAL_GetTick() + Timeout;
+/**
+ * @brief Fills the free mailboxes with the queued messages, most urgent first.
+ *
+ * Must be called with the TX interrupts masked or from a TX interrupt.
+ *
+ * @param can_manager Pointer to the CAN Manager instance.
+ */
+static void __refill_mailboxes(can_manager_t *can_manager)
+{
+    const can_manager_config_t *config = can_manager->config;
+    bool8u mailbox_free = CD_TRUE;
+
+    for (uint8_t i = 0U; (i < config->tx_message_count) && (mailbox_free == CD_TRUE); i++) {
+        const uint8_t tx_index = can_manager->tx_order[i];
 
-    do {
-        if (HAL_CAN_IsTxMessagePending(config->hcan, can_manager->auto_control_tx_mailbox) == CAN_MANAGER_MESSAGE_NOT_PENDING) {
-            abort_complete = CD_TRUE;
+        if ((can_manager->tx_slots[tx_index].state == CAN_MANAGER_TX_QUEUED) &&
+            (__submit_message(can_manager, tx_index) != CAN_MANAGER_OK)) {
+            mailbox_free = CD_FALSE;
         }
-    } while ((abort_complete == CD_FALSE) && (HAL_GetTick() <= stop_time));
+    }
+}
 
-    if (abort_complete == CD_TRUE) {
-        status = CAN_MANAGER_OK;
+/**
+ * @brief Releases a message for its new period.
+ *
+ * If the frame of the previous period is still in a mailbox, the fresh payload
+ * waits behind it. The frame is aborted only if it is still there at the
+ * following release, and the fresh payload follows from the abort complete
+ * interrupt.
+ *
+ * @param can_manager Pointer to the CAN Manager instance.
+ * @param tx_index Index of the message in the TX message table.
+ */
+static void __release_message(can_manager_t *can_manager, uint8_t tx_index)
+{
+    can_manager_tx_slot_t *slot = &can_manager->tx_slots[tx_index];
+
+    CD_ENTER_CRITICAL();
+    switch (slot->state) {
+    case CAN_MANAGER_TX_IDLE:
+        slot->state = CAN_MANAGER_TX_QUEUED;
+        break;
+    case CAN_MANAGER_TX_PENDING:
+        slot->state = CAN_MANAGER_TX_UPDATED;
+        (slot->deadline_miss_cnt)++;
+        __count_occupancy(can_manager);
+        break;
+    case CAN_MANAGER_TX_UPDATED:
+        slot->state = CAN_MANAGER_TX_ABORTING;
+        (can_manager->tx_abort_cnt)++;
+        (void) HAL_CAN_AbortTxRequest(can_manager->config->hcan, slot->mailbox);
+        (slot->deadline_miss_cnt)++;
+        __count_occupancy(can_manager);
+        break;
+    default:
+        /* Still queued or aborting: the fresh payload simply replaces the old one */
+        (slot->deadline_miss_cnt)++;
+        __count_occupancy(can_manager);
+        break;
     }
+    CD_EXIT_CRITICAL();
+}
 
+CanManager_StatusTypeDef can_manager_update_tx_data(can_manager_t *can_manager, uint8_t tx_index, const uint8_t *can_data) {
+    CanManager_StatusTypeDef status = CAN_MANAGER_ERROR;
+    if ((can_manager != NULL) && (can_data != NULL) && (can_manager->config != NULL) &&
+        (tx_index < can_manager->config->tx_message_count)) {
+        CD_ENTER_CRITICAL();
+        (void) memcpy(can_manager->tx_slots[tx_index].data, can_data, CAN_MANAGER_TX_DATA_SIZE);
+        CD_EXIT_CRITICAL();
+        status = CAN_MANAGER_OK;
+    }
     return status;
 }
 
-CanManager_StatusTypeDef __send_message(can_manager_t *can_manager, const uint8_t *can_data){
+CanManager_StatusTypeDef can_manager_tx_step(can_manager_t *can_manager, uint32_t now) {
     CanManager_StatusTypeDef status = CAN_MANAGER_ERROR;
-    const can_manager_config_t *config = (const can_manager_config_t*) can_manager->config;
+    if ((can_manager != NULL) && (can_manager->config != NULL)) {
+        const can_manager_config_t *config = can_manager->config;
+
+        for (uint8_t i = 0U; i < config->tx_message_count; i++) {
+            can_manager_tx_slot_t *slot = &can_manager->tx_slots[i];
+            const uint32_t period_ms = config->tx_messages[i].period_ms;
+
+            if (__tick_reached(now, slot->next_release) == CD_TRUE) {
+                __release_message(can_manager, i);
+                slot->next_release += period_ms;
+
+                /* Skipped releases are not made up in a burst: the schedule is realigned */
+                if (__tick_reached(now, slot->next_release) == CD_TRUE) {
+                    (slot->deadline_miss_cnt)++;
+                    slot->next_release = now + period_ms;
+                }
+            }
 
-    if (HAL_CAN_IsTxMessagePending(config->hcan, can_manager->auto_control_tx_mailbox) == CAN_MANAGER_MESSAGE_NOT_PENDING) {
-    	status=__add_message_to_mailbox(can_manager, can_data);
-    	can_manager->can_occupancy_cnt = 0U;
+        }
+
+        CD_ENTER_CRITICAL();
+        __refill_mailboxes(can_manager);
+        CD_EXIT_CRITICAL();
+
+        __update_stats(can_manager, now);
+
+        if (can_manager->can_occupancy_cnt < MAX_CAN_OCCUPANCY_CNT) {
+            status = CAN_MANAGER_OK;
+        }
     }
-    else
-    {
-    	(can_manager->can_occupancy_cnt)++;
-    	if(can_manager->can_occupancy_cnt > can_manager->max_can_occupancy_cnt){
-    		can_manager->max_can_occupancy_cnt = can_manager->can_occupancy_cnt;
-    	}
-
-    	if((__abort_message(can_manager) == CAN_MANAGER_OK)&&(can_manager->can_occupancy_cnt < MAX_CAN_OCCUPANCY_CNT))
-    	{
-    		status=__add_message_to_mailbox(can_manager, can_data);
-    	}
+    return status;
+}
+
+CanManager_StatusTypeDef can_manager_rx_pop(can_manager_t *can_manager, can_manager_rx_frame_t *frame) {
+    CanManager_StatusTypeDef status = CAN_MANAGER_ERROR;
+    if ((can_manager != NULL) && (frame != NULL)) {
+        can_manager_rx_ring_t *ring = &can_manager->rx_ring;
+        const uint32_t tail = ring->tail;
+
+        if (__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) == tail) {
+            status = CAN_MANAGER_RX_EMPTY;
+        } else {
+            (void) memcpy(frame, &ring->frames[tail & (CAN_MANAGER_RX_RING_SIZE - 1U)], sizeof(*frame));
+            __atomic_store_n(&ring->tail, tail + 1U, __ATOMIC_RELEASE);
+            status = CAN_MANAGER_OK;
+        }
     }
     return status;
 }
 
+/**
+ * @brief Moves every pending frame of a RX FIFO into the RX ring.
+ *
+ * Frames that do not fit are still read out of the FIFO, so that the hardware
+ * never overruns, and are counted as ring overruns.
+ *
+ * @param hcan Pointer to the CAN handle raising the interrupt.
+ * @param rx_fifo FIFO raising the interrupt.
+ */
+static void __rx_fifo_isr(CAN_HandleTypeDef *hcan, uint32_t rx_fifo)
+{
+    can_manager_t *can_manager = isr_instance;
+
+    if ((can_manager != NULL) && (can_manager->config->hcan == hcan) &&
+        (can_manager->config->auto_data_feedback_rx_fifo == rx_fifo)) {
+        can_manager_rx_ring_t *ring = &can_manager->rx_ring;
+        can_manager_rx_frame_t discarded;
+        bool8u fifo_ok = CD_TRUE;
+
+        while ((fifo_ok == CD_TRUE) && (HAL_CAN_GetRxFifoFillLevel(hcan, rx_fifo) > 0U)) {
+            const uint32_t head = ring->head;
+            can_manager_rx_frame_t *frame = &discarded;
+
+            if ((head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE)) < CAN_MANAGER_RX_RING_SIZE) {
+                frame = &ring->frames[head & (CAN_MANAGER_RX_RING_SIZE - 1U)];
+            }
+
+            if (HAL_CAN_GetRxMessage(hcan, rx_fifo, &frame->header, frame->data) != HAL_OK) {
+                fifo_ok = CD_FALSE;
+            } else if (frame == &discarded) {
+                (ring->overrun_cnt)++;
+            } else {
+                frame->rx_tick = CD_GET_TICK();
+                (can_manager->stats.rx_cnt)++;
+                can_manager->stats.window_bits += __frame_bits(frame->header.DLC);
+                __atomic_store_n(&ring->head, head + 1U, __ATOMIC_RELEASE);
+            }
+        }
+    }
+}
+
+void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan)
+{
+    __rx_fifo_isr(hcan, CAN_RX_FIFO0);
+}
+
+void HAL_CAN_RxFifo1MsgPendingCallback(CAN_HandleTypeDef *hcan)
+{
+    __rx_fifo_isr(hcan, CAN_RX_FIFO1);
+}
+
+/**
+ * @brief Advances the TX state of the message held by a mailbox that became empty.
+ *
+ * A message with a fresh release waiting behind the frame is queued again,
+ * then the free mailboxes are refilled with the most urgent queued messages.
+ *
+ * @param hcan Pointer to the CAN handle raising the interrupt.
+ * @param mailbox_index Index of the mailbox that became empty.
+ * @param transmitted CD_TRUE if the frame was transmitted, CD_FALSE if it was aborted.
+ */
+static void __tx_mailbox_isr(CAN_HandleTypeDef *hcan, uint8_t mailbox_index, bool8u transmitted)
+{
+    can_manager_t *can_manager = isr_instance;
+
+    if ((can_manager != NULL) && (can_manager->config->hcan == hcan)) {
+        const uint8_t tx_index = can_manager->tx_mailbox_owner[mailbox_index];
+        can_manager->tx_mailbox_owner[mailbox_index] = CAN_MANAGER_TX_NO_OWNER;
+
+        if (tx_index < can_manager->config->tx_message_count) {
+            can_manager_tx_slot_t *slot = &can_manager->tx_slots[tx_index];
+
+            if (transmitted == CD_TRUE) {
+                (slot->tx_cnt)++;
+                __record_tx_latency(&can_manager->stats, CD_GET_TICK() - slot->submit_tick);
+                can_manager->stats.window_bits += __frame_bits(can_manager->config->tx_messages[tx_index].tx_header.DLC);
+                can_manager->can_occupancy_cnt = 0U;
+            }
+
+            if ((slot->state == CAN_MANAGER_TX_ABORTING) || (slot->state == CAN_MANAGER_TX_UPDATED)) {
+                slot->state = CAN_MANAGER_TX_QUEUED;
+            } else {
+                slot->state = CAN_MANAGER_TX_IDLE;
+            }
+        }
+
+        __refill_mailboxes(can_manager);
+    }
+}
+
+void HAL_CAN_TxMailbox0CompleteCallback(CAN_HandleTypeDef *hcan)
+{
+    __tx_mailbox_isr(hcan, 0U, CD_TRUE);
+}
+
+void HAL_CAN_TxMailbox1CompleteCallback(CAN_HandleTypeDef *hcan)
+{
+    __tx_mailbox_isr(hcan, 1U, CD_TRUE);
+}
 
-CanManager_StatusTypeDef can_manager_auto_control_tx(can_manager_t *can_manager, const uint8_t *can_data) {
+void HAL_CAN_TxMailbox2CompleteCallback(CAN_HandleTypeDef *hcan)
+{
+    __tx_mailbox_isr(hcan, 2U, CD_TRUE);
+}
+
+void HAL_CAN_TxMailbox0AbortCallback(CAN_HandleTypeDef *hcan)
+{
+    __tx_mailbox_isr(hcan, 0U, CD_FALSE);
+}
+
+void HAL_CAN_TxMailbox1AbortCallback(CAN_HandleTypeDef *hcan)
+{
+    __tx_mailbox_isr(hcan, 1U, CD_FALSE);
+}
+
+void HAL_CAN_TxMailbox2AbortCallback(CAN_HandleTypeDef *hcan)
+{
+    __tx_mailbox_isr(hcan, 2U, CD_FALSE);
+}
+
+void HAL_CAN_ErrorCallback(CAN_HandleTypeDef *hcan)
+{
+    /* Arbitration lost and transmission error flags of each TX mailbox */
+    static const uint32_t tx_mailbox_errors[CAN_MANAGER_TX_MAILBOX_COUNT] = {
+        HAL_CAN_ERROR_TX_ALST0 | HAL_CAN_ERROR_TX_TERR0,
+        HAL_CAN_ERROR_TX_ALST1 | HAL_CAN_ERROR_TX_TERR1,
+        HAL_CAN_ERROR_TX_ALST2 | HAL_CAN_ERROR_TX_TERR2
+    };
+    can_manager_t *can_manager = isr_instance;
+    const uint32_t overrun_errors = HAL_CAN_ERROR_RX_FOV0 | HAL_CAN_ERROR_RX_FOV1;
+
+    if ((can_manager != NULL) && (can_manager->config->hcan == hcan)) {
+        const uint32_t errors = HAL_CAN_GetError(hcan);
+        uint32_t handled_errors = 0U;
+
+        if ((errors & overrun_errors) != 0U) {
+            (can_manager->stats.rx_fifo_overrun_cnt)++;
+            handled_errors |= overrun_errors;
+        }
+
+        /* A request completed without TXOK raises this callback instead of
+         * the abort one: the mailbox is free again and its slot must leave
+         * PENDING or ABORTING, or the message is never sent again */
+        for (uint8_t mailbox_index = 0U; mailbox_index < CAN_MANAGER_TX_MAILBOX_COUNT; mailbox_index++) {
+            if ((errors & tx_mailbox_errors[mailbox_index]) != 0U) {
+                handled_errors |= tx_mailbox_errors[mailbox_index];
+                __tx_mailbox_isr(hcan, mailbox_index, CD_FALSE);
+            }
+        }
+
+        /* The error flags accumulate in the handle until they are reset */
+        hcan->ErrorCode &= ~handled_errors;
+    }
+}
+
+CanManager_StatusTypeDef can_manager_get_stats(const can_manager_t *can_manager, can_manager_stats_t *stats) {
     CanManager_StatusTypeDef status = CAN_MANAGER_ERROR;
-    if ((can_manager != NULL) && (can_data != NULL)) {
-        status=__send_message(can_manager,can_data);
+    if ((can_manager != NULL) && (stats != NULL)) {
+        CD_ENTER_CRITICAL();
+        (void) memcpy(stats, &can_manager->stats, sizeof(*stats));
+        CD_EXIT_CRITICAL();
+        status = CAN_MANAGER_OK;
     }
     return status;
 }
-
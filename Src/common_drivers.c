@@ -36,6 +36,11 @@ float map_value_float(float x, float in_min, float in_max, float out_min,
 	return ret_val;
 }
 
+float map_value_float_scaled(float x, float in_min, float in_max, float out_min,
+		float scale) {
+	return ((clamp_float(x, in_min, in_max) - in_min) * scale) + out_min;
+}
+
 float calculate_new_smoothed_value(float current_value, float set_point,
 		float max_increment, float max_decrement) {
 	float error = set_point - current_value;
@@ -48,10 +53,10 @@ float calculate_new_smoothed_value(float current_value, float set_point,
 		if (((current_value > 0.0f) && (error < 0.0f))
 				|| ((current_value < 0.0f) && (error > 0.0f))) {
 			adjustment =
-					(fabs(current_value) <= max_decrement) ?
+					(fabsf(current_value) <= max_decrement) ?
 							-current_value : (error_sign * max_decrement);
 		} else {
-			float abs_error = fabs(error);
+			float abs_error = fabsf(error);
 			adjustment = error_sign
 					* ((abs_error > max_increment) ? max_increment : abs_error);
 		}
@@ -63,7 +68,7 @@ float calculate_new_smoothed_value(float current_value, float set_point,
 	} else {
 		new_smoothed = set_point;
 	}
-	return (float) new_smoothed;
+	return new_smoothed;
 }
 
 /**
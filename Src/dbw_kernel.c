@@ -16,7 +16,7 @@
 static const urb_sender_config_t urb_sender_config = { .phost = &hUsbHostFS };
 
 static const CAN_TxHeaderTypeDef auto_control_tx_header = {
-    .StdId = 0x183,
+    .StdId = AUTO_CONTROL_FRAME_ID,
     .ExtId = 0x0,  
     .IDE = CAN_ID_STD,        // Using standard ID
     .RTR = CAN_RTR_DATA,      // Frame type: data
@@ -24,12 +24,37 @@ static const CAN_TxHeaderTypeDef auto_control_tx_header = {
     .TransmitGlobalTime = DISABLE  // Timestamp disabled
 };
 
+/* Periodic TX messages, messages sharing a period get different phases */
+static const can_manager_tx_message_config_t can_tx_messages[] = {
+    [DBW_AUTO_CONTROL_TX_INDEX] = {
+        .tx_header = auto_control_tx_header,
+        .period_ms = UPDATE_STATE_PERIOD_MS,
+        .phase_ms = 0U
+    }
+};
+
 /* Static Initialization of can_manager_config */
 static const can_manager_config_t can_manager_config = { 
     .hcan = &hcan1, // Pointer to CAN1 handle
-    .auto_control_tx_header = auto_control_tx_header, // Transmission header
+    .tx_messages = can_tx_messages, // Periodic transmission table
+    .tx_message_count = (uint8_t) (sizeof(can_tx_messages) / sizeof(can_tx_messages[0])),
     .auto_data_feedback_rx_fifo = CAN_RX_FIFO0,    // Reception FIFO
-    .auto_data_feedback_rx_interrupt = CAN_IT_RX_FIFO0_MSG_PENDING 
+    .auto_data_feedback_rx_interrupt = CAN_IT_RX_FIFO0_MSG_PENDING,
+    .rx_filter_bank = 0U, // First CAN1 filter bank
+    .bitrate = 500000U // Chassis bus bit rate
+};
+
+/* Feedback older than FEEDBACK_MAX_AGE_MS, once received, stops the vehicle and the steer correction */
+static const auto_data_feedback_freshness_config_t feedback_freshness_config = {
+    .max_age_ms = FEEDBACK_MAX_AGE_MS,
+    .max_extrapolation_ms = FEEDBACK_MAX_EXTRAPOLATION_MS,
+    .stale_policy = AUTO_DATA_FEEDBACK_STALE_SAFE_STATE
+};
+
+/* Constant force changes within FF_DEADBAND, or sooner than FF_MIN_RESEND_MS, produce no URB traffic */
+static const rotation_manager_config_t rotation_manager_config = {
+    .ff_deadband = FF_DEADBAND,
+    .ff_min_resend_ms = FF_MIN_RESEND_MS
 };
 
 static const t818_drive_control_config_t t818_config = { 
@@ -38,16 +63,16 @@ static const t818_drive_control_config_t t818_config = {
 
 /* Initialization of dbw_kernel_state */
 static dbw_kernel_t dbw_kernel_state = {
-    .urb_queueHandle = NULL,
-    .urb_queueBuffer = {0},  // Added extra braces for array initialization
-    .urb_queueControlBlock = {{0}},  // Added extra braces for structure initialization
     .urb_sender = {
         .config = NULL,
-        .xQueue = NULL,
-        .interr_buff = {
-            .msg = {0},  // Added extra braces for array initialization
-            .pipe_num = 0
-        }
+        .pool = {{{0}}},  // Added extra braces for array initialization
+        .free_mask = 0,
+        .queued_mask = {0},
+        .next_seq = 0,
+        .in_flight = {URB_SENDER_NO_PACKET},
+        .queued_by_key = {URB_SENDER_NO_PACKET},
+        .stats = {0},
+        .tx_task = NULL
     },
     .drive_control = {
         .t818_info = NULL,
@@ -60,7 +85,8 @@ static dbw_kernel_t dbw_kernel_state = {
             .buttons = {{0}},  // Added extra braces for array initialization
             .pad_arrow_position = DIRECTION_NONE
         },
-        .state = WAITING_WHEEL_COFIGURATION
+        .state = WAITING_WHEEL_COFIGURATION,
+        .input_settled = CD_FALSE
     },
     .auto_control = {
         .auto_data_feedback = NULL,
@@ -97,28 +123,49 @@ static dbw_kernel_t dbw_kernel_state = {
         .emergency_stop = 0
     },
     .pid = {
-        .ki = 0.0,
-        .kp = 0.0,
-        .kd = 0.0,
-        .e_old = 0.0,
-        .u_old = 0.0
+        .ki = 0,
+        .kp = 0,
+        .kd = 0,
+        .e_old = 0,
+        .u_old = 0
     #ifdef USE_CLAMPING
-        , .ukmax = 0.0,
-        .ukmin = 0.0,
-        .sk = 0.0
+        , .ukmax = 0,
+        .ukmin = 0,
+        .sk = 0
     #endif
     },
     .rotation_manager = {
+        .config = NULL,
         .pid = NULL,
-        .urb_sender = NULL
+        .urb_sender = NULL,
+        .ff_divider = 1,
+        .ff_skip_cnt = 0,
+        .last_ff_value = 0,
+        .last_ff_tick = 0,
+        .ff_playing = CD_FALSE,
+        .ff_resend = CD_FALSE,
+        .ff_loss_cnt = 0,
+        .rate_window_start = 0,
+        .rate_window_sent_cnt = 0,
+        .urb_done_rate = 0,
+        .ff_skipped_cnt = 0,
+        .ff_enqueue_fail_cnt = 0
     },
     .can_manager = {
         .config = NULL,
-        .auto_control_tx_mailbox = 0,
-        .RxHeader = {0},  // Added extra braces for structure initialization
-        .tx_data = {0},  // Added extra braces for array initialization
-        .rx_data = {0}
-    }
+        .tx_slots = {{{0}}},  // Added extra braces for array initialization
+        .rx_ring = {
+            .frames = {{{0}}},  // Added extra braces for array initialization
+            .head = 0,
+            .tail = 0,
+            .overrun_cnt = 0
+        }
+    },
+    .auto_data_feedback_tracker = {
+        .config = NULL,
+        .stale_cnt = 0
+    },
+    .auto_data_feedback_rx_timestamp = 0
 };
 
 /* Constant pointer to the dbw_kernel_t instance */
@@ -145,17 +192,15 @@ dbw_kernel_t* const dbw_kernel_get_instance() {
 DBWKernel_StatusTypeDef dbw_kernel_init(void) {
     DBWKernel_StatusTypeDef status = DBW_ERROR;
 
-    osMessageQStaticDef(urb_queue, 40, urb_interr_msg_t, instance->urb_queueBuffer,  &instance->urb_queueControlBlock);
-	instance->urb_queueHandle = osMessageCreate(osMessageQ(urb_queue), NULL);
-    
     // Initialize URB Sender
-    if ((urb_sender_init(&instance->urb_sender, &urb_sender_config, instance->urb_queueHandle) == URB_SENDER_OK) &&
+    if ((urb_sender_init(&instance->urb_sender, &urb_sender_config) == URB_SENDER_OK) &&
     	(pid_init(&instance->pid,PID_KP, PID_KI, PID_KD, T818_FF_MANAGER_MIN_CONSTANT_VALUE, T818_FF_MANAGER_MAX_CONSTANT_VALUE) == PID_OK) &&
         (t818_drive_control_init(&instance->drive_control, &t818_config, USBH_HID_T818GetInstance()) == T818_DC_OK) &&
 		(auto_data_feedback_init(&instance->auto_data_feedback)== AUTO_DATA_FEEDBACK_OK) &&
+		(auto_data_feedback_tracker_init(&instance->auto_data_feedback_tracker, &feedback_freshness_config) == AUTO_DATA_FEEDBACK_OK) &&
         (auto_control_init(&instance->auto_control, &instance->drive_control.t818_driving_commands,&instance->auto_data_feedback) == AUTO_CONTROL_OK) &&
         (can_manager_init(&instance->can_manager, &can_manager_config) == CAN_MANAGER_OK) &&
-        (rotation_manager_init(&instance->rotation_manager, &instance->pid, &instance->urb_sender) == ROTATION_MANAGER_OK)) {
+        (rotation_manager_init(&instance->rotation_manager, &rotation_manager_config, &instance->pid, &instance->urb_sender) == ROTATION_MANAGER_OK)) {
         
         status = DBW_OK;
     }
@@ -172,16 +217,41 @@ DBWKernel_StatusTypeDef dbw_kernel_init(void) {
  */
 DBWKernel_StatusTypeDef dbw_kernel_update_state_step(void) {
     DBWKernel_StatusTypeDef status = DBW_OK;
-
 #ifdef USE_CAN
-    if (can_parser_from_array_to_auto_control_feedback(dbw_kernel_state.can_manager.rx_data,
-            dbw_kernel_state.auto_control.auto_data_feedback) != CAN_PARSER_OK) {
+    uint8_t tx_data[CAN_MANAGER_TX_DATA_SIZE];
+    can_manager_rx_frame_t rx_frame;
+    CanManager_StatusTypeDef rx_status;
+    auto_data_feedback_t received_feedback;
+
+    /* Decodes only the frames received since the last step */
+    while ((rx_status = can_manager_rx_pop(&dbw_kernel_state.can_manager, &rx_frame)) == CAN_MANAGER_OK) {
+        if ((rx_frame.header.IDE == CAN_ID_STD) && (rx_frame.header.StdId == CAN_SIGNALS_AUTO_DATA_FEEDBACK_ID)) {
+            received_feedback = dbw_kernel_state.auto_data_feedback_tracker.received;
+            if ((can_parser_from_array_to_auto_control_feedback(rx_frame.data, &received_feedback) != CAN_PARSER_OK) ||
+                (auto_data_feedback_tracker_update(&dbw_kernel_state.auto_data_feedback_tracker,
+                        &received_feedback, rx_frame.rx_tick) != AUTO_DATA_FEEDBACK_OK)) {
+                status = DBW_ERROR;
+            }
+            dbw_kernel_state.auto_data_feedback_rx_timestamp = rx_frame.header.Timestamp;
+        }
+    }
+
+    if (rx_status != CAN_MANAGER_RX_EMPTY) {
+        status = DBW_ERROR;
+    }
+
+    /* The control loop only sees feedback filtered by the stale policy */
+    if (auto_data_feedback_tracker_apply(&dbw_kernel_state.auto_data_feedback_tracker, CD_GET_TICK(),
+            dbw_kernel_state.auto_control.auto_data_feedback) != AUTO_DATA_FEEDBACK_OK) {
         status = DBW_ERROR;
     }
 #endif
 
+    const bool8u safe_state = auto_data_feedback_is_safe_state(&dbw_kernel_state.auto_data_feedback_tracker);
+
     if (status == DBW_OK) {
-        if (t818_drive_control_step(&dbw_kernel_state.drive_control, &dbw_kernel_state.urb_sender, &dbw_kernel_state.rotation_manager, dbw_kernel_state.auto_data_feedback.steer) != T818_DC_OK) {
+        if (t818_drive_control_step(&dbw_kernel_state.drive_control, &dbw_kernel_state.urb_sender, &dbw_kernel_state.rotation_manager,
+                dbw_kernel_state.auto_data_feedback.steer, (safe_state == CD_TRUE) ? CD_FALSE : CD_TRUE) != T818_DC_OK) {
             status = DBW_ERROR;
         }
     }
@@ -192,23 +262,58 @@ DBWKernel_StatusTypeDef dbw_kernel_update_state_step(void) {
         }
     }
 
+    /* Lost feedback stops the vehicle, whatever the driving commands */
+    if ((status == DBW_OK) && (safe_state == CD_TRUE)) {
+        if (auto_control_safe_state(&dbw_kernel_state.auto_control) != AUTO_CONTROL_OK) {
+            status = DBW_ERROR;
+        }
+    }
+
 #ifdef USE_CAN
     if (status == DBW_OK) {
-        if (can_parser_from_auto_control_to_array(dbw_kernel_state.auto_control.auto_control_data, dbw_kernel_state.can_manager.tx_data) != CAN_PARSER_OK) {
+        if (can_parser_from_auto_control_to_array(dbw_kernel_state.auto_control.auto_control_data, tx_data) != CAN_PARSER_OK) {
             status = DBW_ERROR;
         }
     }
 
     if (status == DBW_OK) {
-        if (can_manager_auto_control_tx(&dbw_kernel_state.can_manager, dbw_kernel_state.can_manager.tx_data) != CAN_MANAGER_OK) {
+        if (can_manager_update_tx_data(&dbw_kernel_state.can_manager, DBW_AUTO_CONTROL_TX_INDEX, tx_data) != CAN_MANAGER_OK) {
             status = DBW_ERROR;
         }
     }
+
+#ifndef USE_CAN_TX_TASK
+    /* Without a dedicated CAN TX task the update step is the only owner of the schedule */
+    if (can_manager_tx_step(&dbw_kernel_state.can_manager, CD_GET_TICK()) != CAN_MANAGER_OK) {
+        status = DBW_ERROR;
+    }
+#endif
 #endif
 
     return status;
 }
 
+#if defined(USE_CAN) && defined(USE_CAN_TX_TASK)
+/**
+ * @brief Perform a CAN transmission step for the DBW Kernel module.
+ *
+ * This function runs the periodic CAN TX schedule. Calling it every
+ * CAN_TX_PERIOD_MS lets each message be released at its own period and phase.
+ * The dedicated CAN TX task must be its only caller.
+ *
+ * @return Status of the CAN transmission step.
+ */
+DBWKernel_StatusTypeDef dbw_kernel_can_tx_step(void) {
+    DBWKernel_StatusTypeDef status = DBW_OK;
+
+    if (can_manager_tx_step(&dbw_kernel_state.can_manager, CD_GET_TICK()) != CAN_MANAGER_OK) {
+        status = DBW_ERROR;
+    }
+
+    return status;
+}
+#endif
+
 /**
  * @brief Perform a URB transmission step for the DBW Kernel module.
  *
@@ -225,3 +330,33 @@ DBWKernel_StatusTypeDef dbw_kernel_urb_tx_step(void) {
 
     return status;
 }
+
+/**
+ * @brief Wait for a URB event, then perform a URB transmission step.
+ *
+ * Meant to be the body of the URB transmission task loop, without any delay:
+ * it blocks until the previous URB completes or a packet is submitted, or at
+ * most URB_TX_PERIOD_MS.
+ *
+ * @return Status of the URB transmission step.
+ */
+DBWKernel_StatusTypeDef dbw_kernel_urb_tx_wait_step(void) {
+    DBWKernel_StatusTypeDef status = DBW_ERROR;
+
+    if (urb_sender_wait_event(&dbw_kernel_state.urb_sender, pdMS_TO_TICKS(URB_TX_PERIOD_MS)) == URB_SENDER_OK) {
+        status = dbw_kernel_urb_tx_step();
+    }
+
+    return status;
+}
+
+/**
+ * @brief Forward a URB state change to the URB transmission task.
+ *
+ * Meant to be called from HAL_HCD_HC_NotifyURBChange_Callback.
+ *
+ * @param chnum Host channel, which is also the pipe number.
+ */
+void dbw_kernel_urb_notify_from_isr(uint8_t chnum) {
+    urb_sender_notify_from_isr(&dbw_kernel_state.urb_sender, chnum);
+}
@@ -17,7 +17,7 @@
  * @param ukmin Lower clamping limit.
  * @return uint8_t 1 if summation should be stopped, 0 otherwise.
  */
-static inline uint8_t __stop_summation(double u, double e, double ukmax, double ukmin){
+static inline uint8_t __stop_summation(pid_signal_t u, pid_signal_t e, pid_signal_t ukmax, pid_signal_t ukmin){
     return ((u > ukmax && e > 0) || (u < ukmin && e < 0));
 }
 
@@ -35,7 +35,7 @@ static inline uint8_t __stop_summation(double u, double e, double ukmax, double
  * @param ukmax Upper clamping limit.
  * @return PID_StatusTypeDef PID_OK if successful, PID_ERROR otherwise.
  */
-PID_StatusTypeDef pid_init(pid_t *pid, double kp, double ki,double kd, double ukmin, double ukmax){
+PID_StatusTypeDef pid_init(pid_t *pid, pid_gain_t kp, pid_gain_t ki, pid_gain_t kd, pid_signal_t ukmin, pid_signal_t ukmax){
 #else
 /**
  * @brief Initializes the PID regulator without clamping.
@@ -46,9 +46,10 @@ PID_StatusTypeDef pid_init(pid_t *pid, double kp, double ki,double kd, double uk
  * @param pid Pointer to the PID regulator structure.
  * @param kp Proportional gain.
  * @param ki Integral gain.
+ * @param kd Derivative gain.
  * @return PID_StatusTypeDef PID_OK if successful, PID_ERROR otherwise.
  */
-PID_StatusTypeDef pid_init(pid_t *pid, double kp, double ki){
+PID_StatusTypeDef pid_init(pid_t *pid, pid_gain_t kp, pid_gain_t ki, pid_gain_t kd){
 #endif
     PID_StatusTypeDef status = PID_ERROR;
     if(pid != NULL){
@@ -69,6 +70,60 @@ PID_StatusTypeDef pid_init(pid_t *pid, double kp, double ki){
     return status;
 }
 
+#ifdef USE_FIXED_POINT_PID
+
+/**
+ * @brief Rounds a Q15.16 accumulator to an integer and saturates it.
+ *
+ * @param acc Accumulator in Q15.16 format.
+ * @param min Lower saturation limit.
+ * @param max Upper saturation limit.
+ * @return pid_signal_t Saturated integer value.
+ */
+static inline pid_signal_t __q16_to_signal(int64_t acc, pid_signal_t min, pid_signal_t max){
+    int64_t val = (acc + ((int64_t)1 << (PID_GAIN_FRAC_BITS - 1U))) >> PID_GAIN_FRAC_BITS;
+    pid_signal_t ret;
+    if (val < (int64_t)min){
+        ret = min;
+    } else if (val > (int64_t)max){
+        ret = max;
+    } else {
+        ret = (pid_signal_t)val;
+    }
+    return ret;
+}
+
+/**
+ * @brief Saturates a 64-bit value to the int32_t range.
+ *
+ * @param val Value to saturate.
+ * @return pid_signal_t Saturated value.
+ */
+static inline pid_signal_t __saturate_int32(int64_t val){
+    pid_signal_t ret;
+    if (val > (int64_t)INT32_MAX){
+        ret = INT32_MAX;
+    } else if (val < (int64_t)INT32_MIN){
+        ret = INT32_MIN;
+    } else {
+        ret = (pid_signal_t)val;
+    }
+    return ret;
+}
+
+/**
+ * @brief Adds the error to the integral sum, saturating at the int32_t range.
+ *
+ * @param sk Current integral sum.
+ * @param e Current error.
+ * @return pid_signal_t New integral sum.
+ */
+static inline pid_signal_t __saturating_add(pid_signal_t sk, pid_signal_t e){
+    return __saturate_int32((int64_t)sk + (int64_t)e);
+}
+
+#endif
+
 /**
  * @brief Calculates the output of the PID regulator.
  * 
@@ -81,10 +136,17 @@ PID_StatusTypeDef pid_init(pid_t *pid, double kp, double ki){
  * @param u Pointer to the output variable.
  * @return PID_StatusTypeDef PID_OK if successful, PID_ERROR otherwise.
  */
-PID_StatusTypeDef pid_calculate_output(pid_t *pid, double e, double *u){
+PID_StatusTypeDef pid_calculate_output(pid_t *pid, pid_signal_t e, pid_signal_t *u){
     PID_StatusTypeDef status = PID_ERROR;
     if((pid != NULL) && (u != NULL)){
-        #if defined(USE_NO_ANTI_WINDUP)
+        #if defined(USE_FIXED_POINT_PID) && defined(USE_NO_ANTI_WINDUP)
+            *u = __q16_to_signal(((int64_t)pid->u_old * ((int64_t)1 << PID_GAIN_FRAC_BITS)) + ((int64_t)pid->kp * e) + ((int64_t)pid->ki * pid->e_old), INT32_MIN, INT32_MAX);
+        #elif defined(USE_FIXED_POINT_PID) && defined(USE_CLAMPING)
+            if (!__stop_summation(pid->u_old, e, pid->ukmax, pid->ukmin)){
+                pid->sk = __saturating_add(pid->sk, e);
+            }
+            *u = __q16_to_signal(((int64_t)pid->kp * e) + ((int64_t)pid->ki * pid->sk) + ((int64_t)pid->kd * ((int64_t)e - pid->e_old)), pid->ukmin, pid->ukmax);
+        #elif defined(USE_NO_ANTI_WINDUP)
             *u = pid->u_old + pid->kp * e + pid->ki * pid->e_old;
         #elif defined(USE_CLAMPING)
             if (!__stop_summation(pid->u_old, e, pid->ukmax, pid->ukmin)){
@@ -100,11 +162,18 @@ PID_StatusTypeDef pid_calculate_output(pid_t *pid, double e, double *u){
 }
 
 
-PID_StatusTypeDef pid_change_parameters(pid_t *pid, double kp, double ki, double kd)
+PID_StatusTypeDef pid_change_parameters(pid_t *pid, pid_gain_t kp, pid_gain_t ki, pid_gain_t kd)
 {
     PID_StatusTypeDef status = PID_ERROR;
 	if((pid != NULL)){
-		#if defined(USE_CLAMPING)
+		#if defined(USE_CLAMPING) && defined(USE_FIXED_POINT_PID)
+
+			if (ki != 0) {
+				/* A smaller new gain can push the rescaled sum out of range */
+				pid->sk = __saturate_int32(((int64_t)pid->sk * pid->ki) / ki);
+			}
+
+		#elif defined(USE_CLAMPING)
 
 			pid->sk = pid->sk * (pid->ki/ki);
 
@@ -7,14 +7,148 @@
 
 #include "rotation_manager.h"
 
+/**
+ * @brief Measures the URB completion rate and checks the force feedback link.
+ *
+ * A packet expired or dropped by the URB sender may be a constant force
+ * command, so the last value is then marked to be sent again and the effect
+ * played again. A pending play command counts as played once its transfer
+ * has completed.
+ *
+ * @param rotation_manager Pointer to the rotation manager.
+ * @param now Current tick.
+ * @return CD_TRUE if the link cannot keep up with the force feedback commands.
+ */
+static bool8u __check_ff_link(rotation_manager_t *rotation_manager,
+		uint32_t now) {
+	const uint8_t pending_cnt = urb_sender_get_pending_count(
+			rotation_manager->urb_sender);
+	const uint32_t elapsed_ms = now - rotation_manager->rate_window_start;
+	urb_sender_stats_t stats;
+
+	if (urb_sender_get_stats(rotation_manager->urb_sender, &stats)
+			== URB_SENDER_OK) {
+		const uint32_t loss_cnt = stats.expired_cnt + stats.dropped_cnt;
+		const uint32_t play_done_cnt =
+				stats.done_by_key_cnt[T818_FF_MANAGER_COSTANT_PLAY_KEY];
+		if (play_done_cnt != rotation_manager->ff_play_done_cnt) {
+			rotation_manager->ff_play_done_cnt = play_done_cnt;
+			if (rotation_manager->ff_play_pending == CD_TRUE) {
+				rotation_manager->ff_play_pending = CD_FALSE;
+				rotation_manager->ff_playing = CD_TRUE;
+			}
+		}
+		if (loss_cnt != rotation_manager->ff_loss_cnt) {
+			rotation_manager->ff_loss_cnt = loss_cnt;
+			rotation_manager->ff_resend = CD_TRUE;
+			rotation_manager->ff_playing = CD_FALSE;
+			rotation_manager->ff_play_pending = CD_FALSE;
+		}
+		if (elapsed_ms >= ROTATION_MANAGER_RATE_WINDOW_MS) {
+			rotation_manager->urb_done_rate = ((stats.sent_cnt
+					- rotation_manager->rate_window_sent_cnt) * 1000U)
+					/ elapsed_ms;
+			rotation_manager->rate_window_sent_cnt = stats.sent_cnt;
+			rotation_manager->rate_window_start = now;
+		}
+	}
+
+	/* Packets left pending while nothing completes mean the link is stuck */
+	return ((pending_cnt >= ROTATION_MANAGER_CONGESTED_PENDING_CNT)
+			|| ((pending_cnt > 0U) && (rotation_manager->urb_done_rate == 0U))) ?
+			CD_TRUE : CD_FALSE;
+}
+
+/**
+ * @brief Checks whether a new constant force value is worth sending.
+ *
+ * @param rotation_manager Pointer to the rotation manager.
+ * @param value Constant force value.
+ * @param now Current tick.
+ * @return CD_TRUE if the value has to be sent.
+ */
+static inline bool8u __ff_value_due(const rotation_manager_t *rotation_manager,
+		int16_t value, uint32_t now) {
+	const int32_t delta = (int32_t) value
+			- (int32_t) rotation_manager->last_ff_value;
+	bool8u due = CD_FALSE;
+
+	if ((rotation_manager->ff_playing == CD_FALSE)
+			|| (rotation_manager->ff_resend == CD_TRUE)) {
+		due = CD_TRUE;
+	} else if (((delta > (int32_t) rotation_manager->config->ff_deadband)
+			|| (delta < -(int32_t) rotation_manager->config->ff_deadband))
+			&& ((now - rotation_manager->last_ff_tick)
+					>= rotation_manager->config->ff_min_resend_ms)) {
+		due = CD_TRUE;
+	}
+
+	return due;
+}
+
+/**
+ * @brief Sends a constant force command to the wheel.
+ *
+ * The effect is played only if it is neither playing nor about to.
+ *
+ * @param rotation_manager Pointer to the rotation manager.
+ * @param value Constant force value.
+ * @return CD_TRUE if the command was queued.
+ */
+static bool8u __send_ff(rotation_manager_t *rotation_manager, int16_t value) {
+	bool8u sent = CD_FALSE;
+
+	if (t818_ff_manager_upload_costant(rotation_manager->urb_sender, value)
+			== T818_FF_MANAGER_OK) {
+		if ((rotation_manager->ff_playing == CD_TRUE)
+				|| (rotation_manager->ff_play_pending == CD_TRUE)) {
+			sent = CD_TRUE;
+		} else if (t818_ff_manager_play_costant(rotation_manager->urb_sender)
+				== T818_FF_MANAGER_OK) {
+			rotation_manager->ff_play_pending = CD_TRUE;
+			sent = CD_TRUE;
+		}
+	}
+
+	return sent;
+}
+
 Rotation_Manager_StatusTypeDef rotation_manager_init(
-		rotation_manager_t *rotation_manager, pid_t *pid,
+		rotation_manager_t *rotation_manager,
+		const rotation_manager_config_t *config, pid_t *pid,
 		urb_sender_t *urb_sender) {
 	Rotation_Manager_StatusTypeDef status = ROTATION_MANAGER_ERROR;
 
-	if ((rotation_manager != NULL) && (pid != NULL) && (urb_sender != NULL)) {
+	if ((rotation_manager != NULL) && (config != NULL) && (pid != NULL)
+			&& (urb_sender != NULL)) {
+		rotation_manager->config = config;
 		rotation_manager->pid = pid;
 		rotation_manager->urb_sender = urb_sender;
+		rotation_manager->ff_divider = 1U;
+		rotation_manager->ff_skip_cnt = 0U;
+		rotation_manager->rate_window_start = CD_GET_TICK();
+		rotation_manager->rate_window_sent_cnt = 0U;
+		rotation_manager->urb_done_rate = 0U;
+		rotation_manager->ff_skipped_cnt = 0U;
+		rotation_manager->ff_enqueue_fail_cnt = 0U;
+		rotation_manager->ff_loss_cnt = 0U;
+		rotation_manager->ff_play_done_cnt = 0U;
+		status = rotation_manager_reset_ff(rotation_manager);
+	}
+
+	return status;
+}
+
+Rotation_Manager_StatusTypeDef rotation_manager_reset_ff(
+		rotation_manager_t *rotation_manager) {
+	Rotation_Manager_StatusTypeDef status = ROTATION_MANAGER_ERROR;
+
+	if (rotation_manager != NULL) {
+		rotation_manager->last_ff_value = 0;
+		rotation_manager->last_ff_tick = CD_GET_TICK();
+		rotation_manager->ff_playing = CD_FALSE;
+		rotation_manager->ff_play_pending = CD_FALSE;
+		rotation_manager->ff_resend = CD_FALSE;
 		status = ROTATION_MANAGER_OK;
 	}
 
@@ -22,31 +156,60 @@ Rotation_Manager_StatusTypeDef rotation_manager_init(
 }
 
 Rotation_Manager_StatusTypeDef rotation_manager_update(
-		rotation_manager_t *rotation_manager, double auto_steer_feedback,
-		double auto_control_steer) {
+		rotation_manager_t *rotation_manager, float auto_steer_feedback,
+		float auto_control_steer) {
 	Rotation_Manager_StatusTypeDef status = ROTATION_MANAGER_ERROR;
-	double u = 0.0;
-	double e = 0.0;
+	pid_signal_t u = 0;
+	pid_signal_t e = 0;
 	if ((rotation_manager != NULL)) {
 		status = ROTATION_MANAGER_OK;
 		/*e = (double) map_value_float(auto_steer_feedback, 660.0f, 840.0f,
 				-1024.0f, 1024.0f) - (double) auto_control_steer;*/
-		e=auto_steer_feedback-auto_control_steer;
+#ifdef USE_FIXED_POINT_PID
+		/* Rounds instead of truncating toward zero, which would bias the error */
+		e=(pid_signal_t)lroundf(auto_steer_feedback-auto_control_steer);
+#else
+		e=(pid_signal_t)(auto_steer_feedback-auto_control_steer);
+#endif
 
 		if (pid_calculate_output(rotation_manager->pid, e, &u) == PID_ERROR) {
 			status = ROTATION_MANAGER_ERROR;
 		}
 
+		const int16_t value = (int16_t) u;
+		const uint32_t now = CD_GET_TICK();
 
-		if ((t818_ff_manager_upload_costant(rotation_manager->urb_sender,
-				(int16_t) u) == T818_FF_MANAGER_ERROR)
-				|| (t818_ff_manager_play_costant(rotation_manager->urb_sender)
-						== T818_FF_MANAGER_ERROR)) {
-			status = ROTATION_MANAGER_ERROR;
+		if (__check_ff_link(rotation_manager, now) == CD_TRUE) {
+			rotation_manager->ff_divider =
+					(rotation_manager->ff_divider
+							>= (ROTATION_MANAGER_MAX_FF_DIVIDER / 2U)) ?
+							ROTATION_MANAGER_MAX_FF_DIVIDER :
+							(uint8_t) (rotation_manager->ff_divider * 2U);
+		} else if (rotation_manager->ff_divider > 1U) {
+			(rotation_manager->ff_divider)--;
+		}
+
+		if (rotation_manager->ff_skip_cnt < ROTATION_MANAGER_MAX_FF_DIVIDER) {
+			(rotation_manager->ff_skip_cnt)++;
+		}
+		if ((rotation_manager->ff_skip_cnt < rotation_manager->ff_divider)
+				|| (__ff_value_due(rotation_manager, value, now) == CD_FALSE)) {
+			(rotation_manager->ff_skipped_cnt)++;
+		} else if (__send_ff(rotation_manager, value) == CD_TRUE) {
+			rotation_manager->ff_skip_cnt = 0U;
+			rotation_manager->last_ff_value = value;
+			rotation_manager->last_ff_tick = now;
+			rotation_manager->ff_resend = CD_FALSE;
+		} else {
+			/* Sent again once the link recovers, the steering loop keeps running */
+			(rotation_manager->ff_enqueue_fail_cnt)++;
+			rotation_manager->ff_playing = CD_FALSE;
+			rotation_manager->ff_play_pending = CD_FALSE;
+			rotation_manager->ff_skip_cnt = 0U;
+			rotation_manager->ff_divider = ROTATION_MANAGER_MAX_FF_DIVIDER;
 		}
 
 	}
 
 	return status;
 }
-
@@ -48,6 +48,16 @@
  */
 #define MAX_IN_ACTUAL_STEER              (30.0f)
 
+/**
+ * @brief Slope of the steering reference mapping.
+ */
+#define STEER_REFERENCE_SCALE            MAP_VALUE_SCALE(MIN_IN_STEER_REFERENCE, MAX_IN_STEER_REFERENCE, MIN_OUT_STEER, MAX_OUT_STEER)
+
+/**
+ * @brief Slope of the actual steering mapping.
+ */
+#define ACTUAL_STEER_SCALE               MAP_VALUE_SCALE(MIN_IN_ACTUAL_STEER, MAX_IN_ACTUAL_STEER, MIN_OUT_STEER, MAX_OUT_STEER)
+
 typedef Button_StatusTypeDef (*button_init_func_t)(button_t*);
 
 typedef struct {
@@ -121,6 +131,7 @@ T818DriveControl_StatusTypeDef t818_drive_control_init(
 	if ((t818_drive_control != NULL) && (t818_config != NULL)
 			&& (t818_info != NULL)) {
 		t818_drive_control->state = WAITING_WHEEL_COFIGURATION;
+		t818_drive_control->input_settled = CD_FALSE;
 		t818_drive_control->config = t818_config;
 		t818_drive_control->t818_info = t818_info;
 		if (t818_driving_commands_init(
@@ -164,11 +175,38 @@ static inline float __normalize_value(uint16_t value, uint16_t max_value) {
 	return f_value / f_max_value;
 }
 
+/**
+ * @brief Checks if the buttons need no further update.
+ *
+ * A button needs updates while it is pressed, for long presses, and once more
+ * after its raw state changed, so that edges are cleared.
+ *
+ * @param[in] t818_driving_commands Pointer to the driving commands structure.
+ * @return CD_TRUE if every button is released and unchanged, CD_FALSE otherwise.
+ */
+static inline bool8u __buttons_settled(
+		const t818_driving_commands_t *t818_driving_commands) {
+	bool8u settled = CD_TRUE;
+
+	for (uint8_t i = 0; (i < (uint8_t) BUTTON_COUNT) && (settled == CD_TRUE);
+			i++) {
+		if ((t818_driving_commands->buttons[i].actual_raw_state
+				!= BUTTON_NOT_PRESSED)
+				|| (t818_driving_commands->buttons[i].previous_raw_state
+						!= BUTTON_NOT_PRESSED)) {
+			settled = CD_FALSE;
+		}
+	}
+	return settled;
+}
+
 /**
  * @brief Updates the T818 driving control commands.
  *
  * This function updates the driving commands for the T818 device based on the
  * current input values. It includes steering angle, braking, throttle, and clutch.
+ * The update is skipped when no new report was decoded since the last one and
+ * the commands are settled.
  *
  * @param[in,out] t818_drive_control Pointer to the T818 drive control structure.
  * @return Status of the drive control update.
@@ -177,31 +215,37 @@ static inline T818DriveControl_StatusTypeDef __t818_drive_control_update(
 		t818_drive_control_t *t818_drive_control) {
 	T818DriveControl_StatusTypeDef status = T818_DC_ERROR;
 	if (t818_drive_control != NULL) {
-		__disable_irq();
-		t818_drive_control->t818_driving_commands.wheel_steering_degree =
-				__convert_steering_angle(
-						t818_drive_control->t818_info->wheel_rotation);
-		t818_drive_control->t818_driving_commands.braking_module = 1.0f
-				- __normalize_value((t818_drive_control->t818_info->brake),
-				T818_BRAKE_MAX);
-		t818_drive_control->t818_driving_commands.throttling_module = 1.0f
-				- __normalize_value((t818_drive_control->t818_info->throttle),
-				T818_THROTTLE_MAX);
-		t818_drive_control->t818_driving_commands.clutching_module = 1.0f
-				- __normalize_value((t818_drive_control->t818_info->clutch),
-				T818_CLUTCH_MAX);
-
 		Button_StatusTypeDef btn_status = BUTTON_OK;
-		for (uint8_t i = 0;
-				(i < (uint8_t) BUTTON_COUNT) && (btn_status == BUTTON_OK);
-				i++) {
-			btn_status = button_update(
-					&t818_drive_control->t818_driving_commands.buttons[i],
-					t818_drive_control->t818_info->buttons[i]);
+		CD_ENTER_CRITICAL();
+		if ((t818_drive_control->t818_info->changed != 0U)
+				|| (t818_drive_control->input_settled == CD_FALSE)) {
+			t818_drive_control->t818_info->changed = 0U;
+			t818_drive_control->t818_driving_commands.wheel_steering_degree =
+					__convert_steering_angle(
+							t818_drive_control->t818_info->wheel_rotation);
+			t818_drive_control->t818_driving_commands.braking_module = 1.0f
+					- __normalize_value((t818_drive_control->t818_info->brake),
+					T818_BRAKE_MAX);
+			t818_drive_control->t818_driving_commands.throttling_module = 1.0f
+					- __normalize_value((t818_drive_control->t818_info->throttle),
+					T818_THROTTLE_MAX);
+			t818_drive_control->t818_driving_commands.clutching_module = 1.0f
+					- __normalize_value((t818_drive_control->t818_info->clutch),
+					T818_CLUTCH_MAX);
+
+			for (uint8_t i = 0;
+					(i < (uint8_t) BUTTON_COUNT) && (btn_status == BUTTON_OK);
+					i++) {
+				btn_status = button_update(
+						&t818_drive_control->t818_driving_commands.buttons[i],
+						t818_drive_control->t818_info->buttons[i]);
+			}
+			t818_drive_control->t818_driving_commands.pad_arrow_position =
+					(DirectionalPadArrowPosition) t818_drive_control->t818_info->pad_arrow;
+			t818_drive_control->input_settled = __buttons_settled(
+					&t818_drive_control->t818_driving_commands);
 		}
-		t818_drive_control->t818_driving_commands.pad_arrow_position =
-				(DirectionalPadArrowPosition) t818_drive_control->t818_info->pad_arrow;
-		__enable_irq();
+		CD_EXIT_CRITICAL();
 		if (btn_status == BUTTON_OK) {
 			status = T818_DC_OK;
 		}
@@ -234,13 +278,17 @@ static inline bool8u __check_wheel_is_ready(
 	return wheel_ready;
 }
 
-static inline T818DriveControl_StatusTypeDef __update_wheel(t818_drive_control_t *t818_drive_control, rotation_manager_t* rotation_manager,float steer_reference, float actual_steer)
+static inline T818DriveControl_StatusTypeDef __update_wheel(t818_drive_control_t *t818_drive_control, rotation_manager_t* rotation_manager,float steer_reference, bool8u steer_reference_valid, float actual_steer)
 {
 	T818DriveControl_StatusTypeDef status = T818_DC_ERROR;
 
 	if (check_wheel_is_linked(t818_drive_control->config->t818_host_handle) == CD_TRUE) {
+		const float actual = map_value_float_scaled(actual_steer,MIN_IN_ACTUAL_STEER, MAX_IN_ACTUAL_STEER, MIN_OUT_STEER, ACTUAL_STEER_SCALE);
+		/* Without a valid reference the wheel is its own reference: no error, no correction */
+		const float reference = (steer_reference_valid == CD_TRUE) ?
+				map_value_float_scaled(steer_reference, MIN_IN_STEER_REFERENCE, MAX_IN_STEER_REFERENCE, MIN_OUT_STEER, STEER_REFERENCE_SCALE) : actual;
 		if((__t818_drive_control_update(t818_drive_control)==T818_DC_OK) &&
-		   (rotation_manager_update(rotation_manager, map_value_float(steer_reference, MIN_IN_STEER_REFERENCE, MAX_IN_STEER_REFERENCE,MIN_OUT_STEER, MAX_OUT_STEER),map_value_float(actual_steer,MIN_IN_ACTUAL_STEER, MAX_IN_ACTUAL_STEER, MIN_OUT_STEER, MAX_OUT_STEER)) == ROTATION_MANAGER_OK))
+		   (rotation_manager_update(rotation_manager, reference, actual) == ROTATION_MANAGER_OK))
 		{
 			status = T818_DC_OK;
 		}
@@ -254,14 +302,20 @@ static inline T818DriveControl_StatusTypeDef __update_wheel(t818_drive_control_t
 }
 
 T818DriveControl_StatusTypeDef t818_drive_control_step(
-		t818_drive_control_t *t818_drive_control, urb_sender_t *urb_sender, rotation_manager_t* rotation_manager,int16_t steer_feedback) {
+		t818_drive_control_t *t818_drive_control, urb_sender_t *urb_sender, rotation_manager_t* rotation_manager,int16_t steer_feedback, bool8u steer_feedback_valid) {
 	T818DriveControl_StatusTypeDef status = T818_DC_ERROR;
 	if ((t818_drive_control != NULL) && (urb_sender!=NULL) && (rotation_manager != NULL)) {
+		/* Reduces every report received since the last step, no report is not an error */
+		if (check_wheel_is_linked(t818_drive_control->config->t818_host_handle) == CD_TRUE) {
+			(void) USBH_HID_GetT818Info(t818_drive_control->config->t818_host_handle);
+		}
 		switch (t818_drive_control->state) {
 		case WAITING_WHEEL_COFIGURATION:
 			if (__check_wheel_is_ready(t818_drive_control) == CD_TRUE) {
-				if (t818_ff_manager_init(urb_sender) == T818_FF_MANAGER_OK) {
+				if ((t818_ff_manager_init(urb_sender) == T818_FF_MANAGER_OK) &&
+					(rotation_manager_reset_ff(rotation_manager) == ROTATION_MANAGER_OK)) {
 					t818_drive_control->state = MANUAL_DRIVING;
+					t818_drive_control->input_settled = CD_FALSE;
 					status = T818_DC_OK;
 				}
 			} else {
@@ -276,10 +330,10 @@ T818DriveControl_StatusTypeDef t818_drive_control_step(
 			}
 			break;
 		case MANUAL_DRIVING:
-			status=__update_wheel(t818_drive_control,rotation_manager, ZERO_STEER_REFERENCE, t818_drive_control->t818_driving_commands.wheel_steering_degree);
+			status=__update_wheel(t818_drive_control,rotation_manager, ZERO_STEER_REFERENCE, CD_TRUE, t818_drive_control->t818_driving_commands.wheel_steering_degree);
 			break;
 		case AUTONOMOUS_DRIVING:
-			status=__update_wheel(t818_drive_control,rotation_manager, steer_feedback, t818_drive_control->t818_driving_commands.wheel_steering_degree);
+			status=__update_wheel(t818_drive_control,rotation_manager, steer_feedback, steer_feedback_valid, t818_drive_control->t818_driving_commands.wheel_steering_degree);
 			break;
 		default:
 			break;
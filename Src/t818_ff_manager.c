@@ -39,150 +39,94 @@
 /** @brief Pipe index for force feedback management on the T818. */
 #define FF_PIPE_INDEX       										(0x03)
 
+/**
+ * @brief Force feedback packet template.
+ *
+ * Only the bytes up to the last non-zero one are stored, the rest of the
+ * packet is zero. For the T818 packets this is smaller than a list of
+ * (offset, value) pairs.
+ */
+typedef struct {
+    const uint8_t *bytes; /**< Leading bytes of the packet */
+    uint8_t length; /**< Number of leading bytes */
+} ff_template_t;
+
+/**
+ * @brief Defines a force feedback packet template from its leading bytes.
+ */
+#define FF_TEMPLATE(name, ...) \
+    static const uint8_t name##_bytes[] = { __VA_ARGS__ }; \
+    _Static_assert(sizeof(name##_bytes) <= PACKET_SIZE, #name " is longer than a packet"); \
+    static const ff_template_t name = { name##_bytes, (uint8_t) sizeof(name##_bytes) }
+
 
 /** @brief Configuration packet 1 for initializing the T818. */
-static const uint8_t configuration_pack1[PACKET_SIZE] = {
-    0x60, 0x01, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-};
+FF_TEMPLATE(configuration_pack1,
+    0x60, 0x01, 0x04
+);
 
 /** @brief Configuration packet 2 for initializing the T818. */
-static const uint8_t configuration_pack2[PACKET_SIZE] = {
-    0x60, 0x01, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-};
+FF_TEMPLATE(configuration_pack2,
+    0x60, 0x01, 0x05
+);
 
 /** @brief Configuration packet 3 for configuring force intensity. */
-static const uint8_t configuration_pack3[] = {
-  0x60, 0x02, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-};
+FF_TEMPLATE(configuration_pack3,
+    0x60, 0x02, 0xff
+);
 
 /** @brief Configuration packet 4 for configuring dumper. */
-static const uint8_t configuration_pack4[] = {
-  0x0a, 0x04, 0x00, 0x17, 0x00, 0x00, 0x00, 0x80,
-  0x3f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-};
+FF_TEMPLATE(configuration_pack4,
+    0x0a, 0x04, 0x00, 0x17, 0x00, 0x00, 0x00, 0x80,
+    0x3f
+);
 
 /** @brief Configuration packet 5 for configuring force feedback linearity. */
-static const uint8_t configuration_pack5[] = {
-  0x0a, 0x04, 0x00, 0x2f, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-};
+FF_TEMPLATE(configuration_pack5,
+    0x0a, 0x04, 0x00, 0x2f
+);
 
 /** @brief Configuration packet 6 for configuring mode. */
-static const uint8_t configuration_pack6[] = {
-  0x0a, 0x04, 0x00, 0x2a, 0x00, 0x01, 0x01, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-};
+FF_TEMPLATE(configuration_pack6,
+    0x0a, 0x04, 0x00, 0x2a, 0x00, 0x01, 0x01
+);
 
 /** @brief Base packet for setting the gain on the T818. */
-static const uint8_t gain_base[PACKET_SIZE] = {
-    0x60, 0x02, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-};
+FF_TEMPLATE(gain_base,
+    0x60, 0x02, 0xff
+);
 
 /** @brief Packet for uploading the spring effect to the T818. */
-static const uint8_t spring_base[PACKET_SIZE] = {
+FF_TEMPLATE(spring_base,
     0x60, 0x00, 0x01, 0x64, 0x66, 0x26, 0x66, 0x26,
     0xff, 0xfe, 0xff, 0xfe, 0xa6, 0x6a, 0xa6, 0x6a,
     0xfe, 0xff, 0xfe, 0xff, 0xfe, 0xff, 0xfe, 0xff,
     0xdf, 0x58, 0xa6, 0x6a, 0x06, 0x4f, 0xff, 0xff,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-};
+    0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff
+);
 
 /** @brief Base packet for playing effects on the T818. */
-static const uint8_t play_effect_base[PACKET_SIZE] = {
-    0x60, 0x00, 0x01, 0x89, 0x41, 0x01, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-};
+FF_TEMPLATE(play_effect_base,
+    0x60, 0x00, 0x01, 0x89, 0x41, 0x01
+);
 
 /** @brief Base packet for the constant force effect on the T818. */
-static const uint8_t costant_base[PACKET_SIZE] = {
-	0x60, 0x00, 0x01, 0x6A, 0xFF, 0xF0, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x4F,
-	0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF,
-	0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-};
+FF_TEMPLATE(costant_base,
+    0x60, 0x00, 0x01, 0x6a, 0xff, 0xf0, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x4f,
+    0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff,
+    0xff
+);
 
 /** @brief Packet for stopping the currently playing effect on the T818. */
-static const uint8_t stop_effect_base[PACKET_SIZE] = {
-    0x60, 0x00, 0x01, 0x89, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-};
+FF_TEMPLATE(stop_effect_base,
+    0x60, 0x00, 0x01, 0x89
+);
 
 /** @brief Packet for setting the range on the T818. */
-static const uint8_t set_range[PACKET_SIZE] = {
-    0x60, 0x08, 0x11, 0xaa, 0xaa, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-};
+FF_TEMPLATE(set_range,
+    0x60, 0x08, 0x11, 0xaa, 0xaa
+);
 
 static inline int16_t __clamp_int16(int16_t val, int16_t min, int16_t max){
 	int16_t ret = 0;
@@ -196,18 +140,65 @@ static inline int16_t __clamp_int16(int16_t val, int16_t min, int16_t max){
 	return ret;
 }
 
-static inline T818_FF_Manager_StatusTypeDef __send_interrupt_data(urb_sender_t *urb_sender,
-    uint8_t *buff, uint8_t length, uint8_t pipe_index){
+/**
+ * @brief Allocates a force feedback packet and builds it from a template.
+ *
+ * A slot keeps its message while free. If it last held a packet of the same
+ * template, the image is already there and only the value bytes, which every
+ * caller writes, change: the template is not copied again.
+ *
+ * @param urb_sender Pointer to the URB sender.
+ * @param base Pointer to the packet template.
+ * @return Pointer to the packet slot, NULL if no slot is free.
+ */
+static inline urb_packet_t *__alloc_ff_packet(urb_sender_t *urb_sender, const ff_template_t *base) {
+    urb_packet_t *packet = urb_sender_alloc_packet(urb_sender);
+    if (packet != NULL) {
+        if (packet->image != base) {
+            (void) memcpy(packet->msg, base->bytes, base->length);
+            (void) memset(&packet->msg[base->length], 0x00, PACKET_SIZE - base->length);
+            packet->image = base;
+        }
+        /* The T818 output report is always a whole packet */
+        packet->length = PACKET_SIZE;
+        packet->pipe_num = FF_PIPE_INDEX;
+        packet->coalesce_key = URB_SENDER_NO_KEY;
+        packet->lane = URB_SENDER_LANE_BACKGROUND;
+        packet->expires = CD_FALSE;
+        packet->expiry_tick = 0U;
+    }
+    return packet;
+}
+
+/**
+ * @brief Moves a force feedback packet to the real-time lane.
+ *
+ * @param packet Pointer to the packet slot.
+ * @param lifetime_ms Time after which the packet is dropped if still queued, 0 to never drop it.
+ */
+static inline void __set_realtime_packet(urb_packet_t *packet, uint32_t lifetime_ms) {
+    packet->lane = URB_SENDER_LANE_REALTIME;
+    if (lifetime_ms != 0U) {
+        packet->expires = CD_TRUE;
+        packet->expiry_tick = CD_GET_TICK() + lifetime_ms;
+    }
+}
+
+/**
+ * @brief Submits a force feedback packet built in its slot.
+ *
+ * @param urb_sender Pointer to the URB sender.
+ * @param packet Pointer to the packet slot, may be NULL.
+ * @return T818_FF_Manager_StatusTypeDef Status of the operation.
+ */
+static inline T818_FF_Manager_StatusTypeDef __submit_ff_packet(urb_sender_t *urb_sender, urb_packet_t *packet) {
     T818_FF_Manager_StatusTypeDef status = T818_FF_MANAGER_ERROR;
-    urb_interr_msg_t interr_msg;
-    interr_msg.pipe_num = pipe_index;
-    memcpy(interr_msg.msg, buff, length);
-    if(urb_sender_enqueue_msg(urb_sender, &interr_msg) == URB_SENDER_OK){
-    	status = T818_FF_MANAGER_OK;
+    if ((packet != NULL) && (urb_sender_submit_packet(urb_sender, packet) == URB_SENDER_OK)) {
+        status = T818_FF_MANAGER_OK;
     }
     return status;
-
 }
+
 /**
  * @brief Sends a force feedback packet to the device.
  *
@@ -215,21 +206,40 @@ static inline T818_FF_Manager_StatusTypeDef __send_interrupt_data(urb_sender_t *
  * @param buff Pointer to the data buffer to be sent.
  * @return T818_FF_Manager_StatusTypeDef Status of the operation.
  */
-static inline T818_FF_Manager_StatusTypeDef __send_ff_packet(urb_sender_t *urb_sender, const uint8_t *buff) {
-    return __send_interrupt_data(urb_sender, (uint8_t *)buff, PACKET_SIZE, FF_PIPE_INDEX);
+static inline T818_FF_Manager_StatusTypeDef __send_ff_packet(urb_sender_t *urb_sender, const ff_template_t *buff) {
+    return __submit_ff_packet(urb_sender, __alloc_ff_packet(urb_sender, buff));
+}
+
+/**
+ * @brief Sends a configuration packet to the device.
+ *
+ * Configuration goes to the real-time lane as well: a lane is served in
+ * submission order, so no effect packet reaches the wheel before it is
+ * configured.
+ *
+ * @param urb_sender Pointer to the URB sender.
+ * @param base Pointer to the packet template.
+ * @return T818_FF_Manager_StatusTypeDef Status of the operation.
+ */
+static inline T818_FF_Manager_StatusTypeDef __send_config_packet(urb_sender_t *urb_sender, const ff_template_t *base) {
+    urb_packet_t *packet = __alloc_ff_packet(urb_sender, base);
+    if (packet != NULL) {
+        __set_realtime_packet(packet, 0U);
+    }
+    return __submit_ff_packet(urb_sender, packet);
 }
 
 T818_FF_Manager_StatusTypeDef t818_ff_manager_init(urb_sender_t *urb_sender) {
     T818_FF_Manager_StatusTypeDef status = T818_FF_MANAGER_ERROR;
     if ((urb_sender != NULL) &&
-        (__send_ff_packet(urb_sender, configuration_pack1) == T818_FF_MANAGER_OK) &&
-        (__send_ff_packet(urb_sender, configuration_pack2) == T818_FF_MANAGER_OK) &&
-		(__send_ff_packet(urb_sender, configuration_pack3) == T818_FF_MANAGER_OK) &&
-		(__send_ff_packet(urb_sender, configuration_pack4) == T818_FF_MANAGER_OK) &&
-		(__send_ff_packet(urb_sender, configuration_pack5) == T818_FF_MANAGER_OK) &&
-		(__send_ff_packet(urb_sender, configuration_pack6) == T818_FF_MANAGER_OK) &&
-		(__send_ff_packet(urb_sender, configuration_pack6) == T818_FF_MANAGER_OK) &&
-        (__send_ff_packet(urb_sender, set_range) == T818_FF_MANAGER_OK) &&
+        (__send_config_packet(urb_sender, &configuration_pack1) == T818_FF_MANAGER_OK) &&
+        (__send_config_packet(urb_sender, &configuration_pack2) == T818_FF_MANAGER_OK) &&
+		(__send_config_packet(urb_sender, &configuration_pack3) == T818_FF_MANAGER_OK) &&
+		(__send_config_packet(urb_sender, &configuration_pack4) == T818_FF_MANAGER_OK) &&
+		(__send_config_packet(urb_sender, &configuration_pack5) == T818_FF_MANAGER_OK) &&
+		(__send_config_packet(urb_sender, &configuration_pack6) == T818_FF_MANAGER_OK) &&
+		(__send_config_packet(urb_sender, &configuration_pack6) == T818_FF_MANAGER_OK) &&
+        (__send_config_packet(urb_sender, &set_range) == T818_FF_MANAGER_OK) &&
         (t818_ff_manager_set_gain(urb_sender, 0xFF) == T818_FF_MANAGER_OK) /*&&
         (t818_ff_manager_upload_spring(urb_sender,0x2666) == T818_FF_MANAGER_OK) &&
         (t818_ff_manager_play_spring(urb_sender) == T818_FF_MANAGER_OK)*/) {
@@ -242,11 +252,13 @@ T818_FF_Manager_StatusTypeDef t818_ff_manager_init(urb_sender_t *urb_sender) {
 T818_FF_Manager_StatusTypeDef t818_ff_manager_set_gain(urb_sender_t *urb_sender, uint8_t value) {
     T818_FF_Manager_StatusTypeDef status = T818_FF_MANAGER_ERROR;
     if (urb_sender != NULL) {
-    	uint8_t tx_data[PACKET_SIZE];
-       if(memcpy(tx_data, (uint8_t*) gain_base, PACKET_SIZE) == tx_data){
-            tx_data[GAIN_INDEX] = value;
-            status = __send_ff_packet(urb_sender, tx_data);
-       }
+        urb_packet_t *packet = __alloc_ff_packet(urb_sender, &gain_base);
+        if (packet != NULL) {
+            packet->msg[GAIN_INDEX] = value;
+            /* Sent in order with the configuration and the effects */
+            __set_realtime_packet(packet, 0U);
+        }
+        status = __submit_ff_packet(urb_sender, packet);
     }
     return status;
 }
@@ -254,15 +266,15 @@ T818_FF_Manager_StatusTypeDef t818_ff_manager_set_gain(urb_sender_t *urb_sender,
 T818_FF_Manager_StatusTypeDef t818_ff_manager_upload_spring(urb_sender_t *urb_sender, uint16_t value) {
 	T818_FF_Manager_StatusTypeDef status = T818_FF_MANAGER_ERROR;
 	    if (urb_sender != NULL) {
-	        uint8_t tx_data[PACKET_SIZE];
-	        if (memcpy(tx_data, spring_base, PACKET_SIZE) == tx_data) {
-	            tx_data[ID_INDEX] = SPRING_ID;
-	            tx_data[SPRING_FIRST_LOW_VALUE_INDEX] = value & 0x00FF;
-	            tx_data[SPRING_FIRST_HI_VALUE_INDEX] = (value >> 8) & (0x00FF);
-	            tx_data[SPRING_SECOND_LOW_VALUE_INDEX] = value & 0x00FF;
-				tx_data[SPRING_SECOND_HI_VALUE_INDEX] = (value >> 8) & (0x00FF);
-	            status = __send_ff_packet(urb_sender, tx_data);
+	        urb_packet_t *packet = __alloc_ff_packet(urb_sender, &spring_base);
+	        if (packet != NULL) {
+	            packet->msg[ID_INDEX] = SPRING_ID;
+	            packet->msg[SPRING_FIRST_LOW_VALUE_INDEX] = value & 0x00FF;
+	            packet->msg[SPRING_FIRST_HI_VALUE_INDEX] = (value >> 8) & (0x00FF);
+	            packet->msg[SPRING_SECOND_LOW_VALUE_INDEX] = value & 0x00FF;
+	            packet->msg[SPRING_SECOND_HI_VALUE_INDEX] = (value >> 8) & (0x00FF);
 	        }
+	        status = __submit_ff_packet(urb_sender, packet);
 	    }
 	    return status;
 }
@@ -271,13 +283,15 @@ T818_FF_Manager_StatusTypeDef t818_ff_manager_upload_costant(urb_sender_t *urb_s
     T818_FF_Manager_StatusTypeDef status = T818_FF_MANAGER_ERROR;
     int16_t clamped_val = __clamp_int16(value, T818_FF_MANAGER_MIN_CONSTANT_VALUE, T818_FF_MANAGER_MAX_CONSTANT_VALUE);
     if (urb_sender != NULL) {
-        uint8_t tx_data[PACKET_SIZE];
-        if (memcpy(tx_data, costant_base, PACKET_SIZE) == tx_data) {
-            tx_data[ID_INDEX] = COSTANT_ID;
-            tx_data[COSTANT_LOW_VALUE_INDEX] = clamped_val & 0x00FF;
-            tx_data[COSTANT_HI_VALUE_INDEX] = (clamped_val >> 8) & (0x00FF);
-            status = __send_ff_packet(urb_sender, tx_data);
+        urb_packet_t *packet = __alloc_ff_packet(urb_sender, &costant_base);
+        if (packet != NULL) {
+            packet->msg[ID_INDEX] = COSTANT_ID;
+            packet->msg[COSTANT_LOW_VALUE_INDEX] = clamped_val & 0x00FF;
+            packet->msg[COSTANT_HI_VALUE_INDEX] = (clamped_val >> 8) & (0x00FF);
+            packet->coalesce_key = T818_FF_MANAGER_COSTANT_UPLOAD_KEY;
+            __set_realtime_packet(packet, T818_FF_MANAGER_COSTANT_LIFETIME_MS);
         }
+        status = __submit_ff_packet(urb_sender, packet);
     }
     return status;
 }
@@ -285,11 +299,11 @@ T818_FF_Manager_StatusTypeDef t818_ff_manager_upload_costant(urb_sender_t *urb_s
 T818_FF_Manager_StatusTypeDef t818_ff_manager_play_spring(urb_sender_t *urb_sender) {
     T818_FF_Manager_StatusTypeDef status = T818_FF_MANAGER_ERROR;
     if (urb_sender != NULL) {
-        uint8_t tx_data[PACKET_SIZE];
-        if (memcpy(tx_data, play_effect_base, PACKET_SIZE) == tx_data) {
-            tx_data[ID_INDEX] = SPRING_ID;
-            status = __send_ff_packet(urb_sender, tx_data);
+        urb_packet_t *packet = __alloc_ff_packet(urb_sender, &play_effect_base);
+        if (packet != NULL) {
+            packet->msg[ID_INDEX] = SPRING_ID;
         }
+        status = __submit_ff_packet(urb_sender, packet);
     }
     return status;
 }
@@ -297,11 +311,14 @@ T818_FF_Manager_StatusTypeDef t818_ff_manager_play_spring(urb_sender_t *urb_send
 T818_FF_Manager_StatusTypeDef t818_ff_manager_play_costant(urb_sender_t *urb_sender) {
     T818_FF_Manager_StatusTypeDef status = T818_FF_MANAGER_ERROR;
     if (urb_sender != NULL) {
-        uint8_t tx_data[PACKET_SIZE];
-        if (memcpy(tx_data, play_effect_base, PACKET_SIZE) == tx_data) {
-            tx_data[ID_INDEX] = COSTANT_ID;
-            status = __send_ff_packet(urb_sender, tx_data);
+        urb_packet_t *packet = __alloc_ff_packet(urb_sender, &play_effect_base);
+        if (packet != NULL) {
+            packet->msg[ID_INDEX] = COSTANT_ID;
+            packet->coalesce_key = T818_FF_MANAGER_COSTANT_PLAY_KEY;
+            /* The effect is played once and then only uploaded again, so play never expires */
+            __set_realtime_packet(packet, 0U);
         }
+        status = __submit_ff_packet(urb_sender, packet);
     }
     return status;
 }
@@ -309,11 +326,12 @@ T818_FF_Manager_StatusTypeDef t818_ff_manager_play_costant(urb_sender_t *urb_sen
 T818_FF_Manager_StatusTypeDef t818_ff_manager_stop_spring(urb_sender_t *urb_sender) {
     T818_FF_Manager_StatusTypeDef status = T818_FF_MANAGER_ERROR;
     if (urb_sender != NULL) {
-        uint8_t tx_data[PACKET_SIZE];
-        if (memcpy(tx_data, stop_effect_base, PACKET_SIZE) == tx_data) {
-            tx_data[ID_INDEX] = SPRING_ID;
-            status = __send_ff_packet(urb_sender, tx_data);
+        urb_packet_t *packet = __alloc_ff_packet(urb_sender, &stop_effect_base);
+        if (packet != NULL) {
+            packet->msg[ID_INDEX] = SPRING_ID;
+            __set_realtime_packet(packet, 0U);
         }
+        status = __submit_ff_packet(urb_sender, packet);
     }
     return status;
 }
@@ -321,11 +339,12 @@ T818_FF_Manager_StatusTypeDef t818_ff_manager_stop_spring(urb_sender_t *urb_send
 T818_FF_Manager_StatusTypeDef t818_ff_manager_stop_costant(urb_sender_t *urb_sender) {
     T818_FF_Manager_StatusTypeDef status = T818_FF_MANAGER_ERROR;
     if (urb_sender != NULL) {
-        uint8_t tx_data[PACKET_SIZE];
-        if (memcpy(tx_data, stop_effect_base, PACKET_SIZE) == tx_data) {
-            tx_data[ID_INDEX] = COSTANT_ID;
-            status = __send_ff_packet(urb_sender, tx_data);
+        urb_packet_t *packet = __alloc_ff_packet(urb_sender, &stop_effect_base);
+        if (packet != NULL) {
+            packet->msg[ID_INDEX] = COSTANT_ID;
+            __set_realtime_packet(packet, 0U);
         }
+        status = __submit_ff_packet(urb_sender, packet);
     }
     return status;
 }
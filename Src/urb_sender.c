@@ -11,44 +11,373 @@
 
 #include <urb_sender.h>
 
-URBSender_StatusTypeDef urb_sender_init(urb_sender_t *urb_sender, const urb_sender_config_t *config, osMessageQId xQueue) {
+/**
+ * @brief Converts a slot pointer into its index.
+ *
+ * @param urb_sender Pointer to the URB sender structure.
+ * @param packet Pointer to the slot.
+ * @return Index of the slot, URB_SENDER_NO_PACKET if the pointer is not a slot of the pool.
+ */
+static inline uint8_t __packet_index(const urb_sender_t *urb_sender, const urb_packet_t *packet) {
+    uint8_t index = URB_SENDER_NO_PACKET;
+    if ((packet >= &urb_sender->pool[0]) && (packet < &urb_sender->pool[URB_SENDER_POOL_SIZE])) {
+        index = (uint8_t) (packet - &urb_sender->pool[0]);
+    }
+    return index;
+}
+
+/**
+ * @brief Gives a slot back to the pool.
+ *
+ * @param urb_sender Pointer to the URB sender structure.
+ * @param index Index of the slot.
+ */
+static inline void __free_slot(urb_sender_t *urb_sender, uint8_t index) {
+    CD_ENTER_CRITICAL();
+    urb_sender->free_mask |= (1UL << index);
+    CD_EXIT_CRITICAL();
+}
+
+/**
+ * @brief Removes a slot from its lane and forgets its coalescing key.
+ *
+ * Must be called with interrupts masked.
+ *
+ * @param urb_sender Pointer to the URB sender structure.
+ * @param lane Lane of the slot.
+ * @param index Index of the slot.
+ */
+static inline void __unqueue_slot(urb_sender_t *urb_sender, uint8_t lane, uint8_t index) {
+    const uint8_t key = urb_sender->pool[index].coalesce_key;
+    urb_sender->queued_mask[lane] &= ~(1UL << index);
+    if ((key < URB_SENDER_COALESCE_KEYS) && (urb_sender->queued_by_key[key] == index)) {
+        urb_sender->queued_by_key[key] = URB_SENDER_NO_PACKET;
+    }
+}
+
+/**
+ * @brief Checks whether a queued packet has passed its expiry tick.
+ *
+ * @param packet Pointer to the packet.
+ * @param now Current tick.
+ * @return CD_TRUE if the packet must be dropped.
+ */
+static inline bool8u __packet_expired(const urb_packet_t *packet, uint32_t now) {
+    return ((packet->expires == CD_TRUE) && ((int32_t) (now - packet->expiry_tick) > 0)) ? CD_TRUE : CD_FALSE;
+}
+
+/**
+ * @brief Queues again a slot whose transfer is to be retried.
+ *
+ * The slot keeps its sequence number, so it is the next one sent on its pipe.
+ * If a newer packet with the same coalescing key has been queued meanwhile, the
+ * slot is released instead.
+ *
+ * @param urb_sender Pointer to the URB sender structure.
+ * @param index Index of the slot.
+ */
+static inline void __requeue_slot(urb_sender_t *urb_sender, uint8_t index) {
+    const urb_packet_t *packet = &urb_sender->pool[index];
+    const uint8_t key = packet->coalesce_key;
+    CD_ENTER_CRITICAL();
+    if ((key != URB_SENDER_NO_KEY) && (urb_sender->queued_by_key[key] != URB_SENDER_NO_PACKET)) {
+        urb_sender->free_mask |= (1UL << index);
+        (urb_sender->stats.coalesced_cnt)++;
+    } else {
+        urb_sender->queued_mask[packet->lane] |= (1UL << index);
+        if (key != URB_SENDER_NO_KEY) {
+            urb_sender->queued_by_key[key] = index;
+        }
+    }
+    CD_EXIT_CRITICAL();
+}
+
+/**
+ * @brief Records a submission to URB done latency in its histogram bin.
+ *
+ * @param stats Pointer to the statistics.
+ * @param latency_ms Latency in milliseconds.
+ */
+static inline void __record_latency(urb_sender_stats_t *stats, uint32_t latency_ms) {
+    uint8_t bin = 0U;
+    while ((latency_ms > 0U) && (bin < (URB_SENDER_LATENCY_BINS - 1U))) {
+        latency_ms >>= 1U;
+        bin++;
+    }
+    (stats->latency_hist[bin])++;
+}
+
+/**
+ * @brief Handles the outcome of a finished transfer.
+ *
+ * @param urb_sender Pointer to the URB sender structure.
+ * @param index Index of the slot that was sent.
+ * @param urb_state Final state of the URB.
+ * @param now Current tick.
+ */
+static void __complete_transfer(urb_sender_t *urb_sender, uint8_t index, USBH_URBStateTypeDef urb_state, uint32_t now) {
+    urb_packet_t *packet = &urb_sender->pool[index];
+    if (urb_state == USBH_URB_DONE) {
+        (urb_sender->stats.sent_cnt)++;
+        (urb_sender->stats.done_by_key_cnt[packet->coalesce_key])++;
+        __record_latency(&urb_sender->stats, now - packet->submit_tick);
+        __free_slot(urb_sender, index);
+    } else if ((urb_state != USBH_URB_STALL) && (packet->retry_cnt < URB_SENDER_MAX_RETRIES)) {
+        /* NAK and transaction errors are transient, an expired packet is dropped when taken */
+        (packet->retry_cnt)++;
+        (urb_sender->stats.retried_cnt)++;
+        __requeue_slot(urb_sender, index);
+    } else {
+        (urb_sender->stats.dropped_cnt)++;
+        __free_slot(urb_sender, index);
+    }
+}
+
+/**
+ * @brief Takes the next packet to be sent out of the queued slots.
+ *
+ * The lanes are scanned in priority order and, in the first lane holding a
+ * packet for an idle pipe, the oldest such packet is taken. Expired packets met
+ * during the scan are dropped.
+ *
+ * @param urb_sender Pointer to the URB sender structure.
+ * @param held_pipes One bit per pipe not to be served, even if idle.
+ * @param now Current tick.
+ * @return Index of the slot to be sent, URB_SENDER_NO_PACKET if none.
+ */
+static uint8_t __take_next_packet(urb_sender_t *urb_sender, uint32_t held_pipes, uint32_t now) {
+    uint8_t next = URB_SENDER_NO_PACKET;
+    CD_ENTER_CRITICAL();
+    for (uint8_t lane = 0U; (lane < URB_SENDER_LANE_COUNT) && (next == URB_SENDER_NO_PACKET); lane++) {
+        uint32_t pending = urb_sender->queued_mask[lane];
+        while (pending != 0U) {
+            const uint8_t index = (uint8_t) __builtin_ctz(pending);
+            const urb_packet_t *packet = &urb_sender->pool[index];
+            pending &= ~(1UL << index);
+            if (__packet_expired(packet, now) == CD_TRUE) {
+                /* An outdated effect is worse than none */
+                __unqueue_slot(urb_sender, lane, index);
+                urb_sender->free_mask |= (1UL << index);
+                (urb_sender->stats.expired_cnt)++;
+            } else if ((urb_sender->in_flight[packet->pipe_num] == URB_SENDER_NO_PACKET) &&
+                       ((held_pipes & (1UL << packet->pipe_num)) == 0U) &&
+                       ((next == URB_SENDER_NO_PACKET) ||
+                        ((int32_t) (packet->seq - urb_sender->pool[next].seq) < 0))) {
+                next = index;
+            }
+        }
+        if (next != URB_SENDER_NO_PACKET) {
+            __unqueue_slot(urb_sender, lane, next);
+        }
+    }
+    CD_EXIT_CRITICAL();
+    return next;
+}
+
+URBSender_StatusTypeDef urb_sender_init(urb_sender_t *urb_sender, const urb_sender_config_t *config) {
     URBSender_StatusTypeDef status = URB_SENDER_ERROR;
-    if ((urb_sender != NULL) && (config != NULL) && (config->phost != NULL) && (xQueue != NULL)) {
+    if ((urb_sender != NULL) && (config != NULL) && (config->phost != NULL)) {
         urb_sender->config = config;
-        urb_sender->xQueue = xQueue;
+        urb_sender->free_mask = (URB_SENDER_POOL_SIZE == 32U) ? 0xFFFFFFFFUL : ((1UL << URB_SENDER_POOL_SIZE) - 1UL);
+        for (uint8_t lane = 0U; lane < URB_SENDER_LANE_COUNT; lane++) {
+            urb_sender->queued_mask[lane] = 0U;
+        }
+        urb_sender->next_seq = 0U;
+        for (uint8_t i = 0U; i < URB_SENDER_POOL_SIZE; i++) {
+            urb_sender->pool[i].image = NULL;
+        }
+        for (uint8_t pipe = 0U; pipe < URB_SENDER_MAX_PIPES; pipe++) {
+            urb_sender->in_flight[pipe] = URB_SENDER_NO_PACKET;
+        }
+        for (uint8_t i = 0U; i < URB_SENDER_COALESCE_KEYS; i++) {
+            urb_sender->queued_by_key[i] = URB_SENDER_NO_PACKET;
+        }
+        (void) memset(&urb_sender->stats, 0x00, sizeof(urb_sender->stats));
+        urb_sender->tx_task = NULL;
+        status = URB_SENDER_OK;
+    }
+    return status;
+}
+
+urb_packet_t *urb_sender_alloc_packet(urb_sender_t *urb_sender) {
+    urb_packet_t *packet = NULL;
+    if (urb_sender != NULL) {
+        CD_ENTER_CRITICAL();
+        if (urb_sender->free_mask != 0U) {
+            const uint8_t index = (uint8_t) __builtin_ctz(urb_sender->free_mask);
+            urb_sender->free_mask &= ~(1UL << index);
+            packet = &urb_sender->pool[index];
+        }
+        CD_EXIT_CRITICAL();
+    }
+    return packet;
+}
+
+URBSender_StatusTypeDef urb_sender_release_packet(urb_sender_t *urb_sender, urb_packet_t *packet) {
+    URBSender_StatusTypeDef status = URB_SENDER_ERROR;
+    if ((urb_sender != NULL) && (__packet_index(urb_sender, packet) != URB_SENDER_NO_PACKET)) {
+        __free_slot(urb_sender, __packet_index(urb_sender, packet));
         status = URB_SENDER_OK;
     }
     return status;
 }
 
-URBSender_StatusTypeDef urb_sender_enqueue_msg(urb_sender_t *urb_sender, const urb_interr_msg_t *interr_msg) {
+URBSender_StatusTypeDef urb_sender_submit_packet(urb_sender_t *urb_sender, urb_packet_t *packet) {
     URBSender_StatusTypeDef status = URB_SENDER_ERROR;
     if (urb_sender != NULL) {
-        if (xQueueSend(urb_sender->xQueue, interr_msg, 0U) == pdPASS) {
+        const uint8_t index = __packet_index(urb_sender, packet);
+        if ((index != URB_SENDER_NO_PACKET) && (packet->length <= URB_MESSAGE_DIM) &&
+            (packet->coalesce_key < URB_SENDER_COALESCE_KEYS) && (packet->lane < URB_SENDER_LANE_COUNT) &&
+            (packet->pipe_num < URB_SENDER_MAX_PIPES)) {
+            const uint8_t key = packet->coalesce_key;
+            bool8u coalesced = CD_FALSE;
+
+            /* The consumer takes queued slots under the same lock */
+            CD_ENTER_CRITICAL();
+            packet->submit_tick = CD_GET_TICK();
+            packet->retry_cnt = 0U;
+            const uint8_t queued = (key != URB_SENDER_NO_KEY) ? urb_sender->queued_by_key[key] : URB_SENDER_NO_PACKET;
+            if (queued != URB_SENDER_NO_PACKET) {
+                /* The new slot takes the place of the queued one, nothing is copied */
+                const urb_packet_t *target = &urb_sender->pool[queued];
+                packet->lane = target->lane;
+                packet->seq = target->seq;
+                urb_sender->queued_mask[packet->lane] = (urb_sender->queued_mask[packet->lane] & ~(1UL << queued)) | (1UL << index);
+                urb_sender->queued_by_key[key] = index;
+                /* Counted under the lock, as the requeue of a failed transfer does */
+                (urb_sender->stats.coalesced_cnt)++;
+                coalesced = CD_TRUE;
+            } else {
+                packet->seq = (urb_sender->next_seq)++;
+                urb_sender->queued_mask[packet->lane] |= (1UL << index);
+                if (key != URB_SENDER_NO_KEY) {
+                    urb_sender->queued_by_key[key] = index;
+                }
+                const uint8_t queued_cnt = (uint8_t) __builtin_popcount(urb_sender->queued_mask[URB_SENDER_LANE_REALTIME] |
+                                                                         urb_sender->queued_mask[URB_SENDER_LANE_BACKGROUND]);
+                if (queued_cnt > urb_sender->stats.queue_hwm) {
+                    urb_sender->stats.queue_hwm = queued_cnt;
+                }
+            }
+            CD_EXIT_CRITICAL();
+
+            if (coalesced == CD_TRUE) {
+                __free_slot(urb_sender, queued);
+            }
             status = URB_SENDER_OK;
+        } else if (index != URB_SENDER_NO_PACKET) {
+            __free_slot(urb_sender, index);
         }
     }
+    if ((status == URB_SENDER_OK) && (urb_sender->tx_task != NULL)) {
+        (void) xTaskNotifyGive(urb_sender->tx_task);
+    }
     return status;
 }
 
 URBSender_StatusTypeDef urb_sender_dequeue_msg(urb_sender_t *urb_sender) {
     URBSender_StatusTypeDef status = URB_SENDER_ERROR;
     if (urb_sender != NULL) {
-        if ((check_wheel_is_linked(urb_sender->config->phost) == CD_TRUE) &&
-            (uxQueueMessagesWaiting(urb_sender->xQueue) > 0U)) {
-            urb_interr_msg_t *interr_buff = &urb_sender->interr_buff;
-            if (xQueuePeek(urb_sender->xQueue, interr_buff, 0U) == pdPASS) {
-                USBH_URBStateTypeDef urb_status = USBH_LL_GetURBState(urb_sender->config->phost, interr_buff->pipe_num);
-                if ((urb_status == USBH_URB_DONE) || (urb_status == USBH_URB_IDLE)) {
-                    (void)USBH_InterruptSendData(urb_sender->config->phost, interr_buff->msg, URB_MESSAGE_DIM, interr_buff->pipe_num);
-                    if (xQueueReceive(urb_sender->xQueue, interr_buff, 0U) == pdPASS) {
-                        status = URB_SENDER_OK;
+        status = URB_SENDER_OK;
+        if (check_wheel_is_linked(urb_sender->config->phost) == CD_TRUE) {
+            const uint32_t now = CD_GET_TICK();
+
+            /* A slot is read by the host channel until its transfer leaves the IDLE state */
+            for (uint8_t pipe = 0U; pipe < URB_SENDER_MAX_PIPES; pipe++) {
+                const uint8_t index = urb_sender->in_flight[pipe];
+                if (index != URB_SENDER_NO_PACKET) {
+                    const USBH_URBStateTypeDef urb_state = USBH_LL_GetURBState(urb_sender->config->phost, pipe);
+                    if (urb_state != USBH_URB_IDLE) {
+                        urb_sender->in_flight[pipe] = URB_SENDER_NO_PACKET;
+                        __complete_transfer(urb_sender, index, urb_state, now);
                     }
                 }
             }
+
+            uint32_t held_pipes = 0U;
+            uint8_t index = __take_next_packet(urb_sender, held_pipes, now);
+            while (index != URB_SENDER_NO_PACKET) {
+                urb_packet_t *packet = &urb_sender->pool[index];
+                if (USBH_InterruptSendData(urb_sender->config->phost, packet->msg, packet->length, packet->pipe_num) == USBH_OK) {
+                    urb_sender->in_flight[packet->pipe_num] = index;
+                } else {
+                    /* The host could not take the URB now: the packet keeps its place at
+                     * the head of its pipe and is tried again at the next step */
+                    (urb_sender->stats.deferred_cnt)++;
+                    __requeue_slot(urb_sender, index);
+                    held_pipes |= (1UL << packet->pipe_num);
+                }
+                index = __take_next_packet(urb_sender, held_pipes, now);
+            }
         } else {
-            status = URB_SENDER_OK;
+            /* Transfers interrupted by the unplug never complete */
+            for (uint8_t pipe = 0U; pipe < URB_SENDER_MAX_PIPES; pipe++) {
+                if (urb_sender->in_flight[pipe] != URB_SENDER_NO_PACKET) {
+                    __free_slot(urb_sender, urb_sender->in_flight[pipe]);
+                    urb_sender->in_flight[pipe] = URB_SENDER_NO_PACKET;
+                }
+            }
+            /* Queued packets were meant for the unplugged device, the next one is configured again */
+            CD_ENTER_CRITICAL();
+            for (uint8_t lane = 0U; lane < URB_SENDER_LANE_COUNT; lane++) {
+                urb_sender->stats.dropped_cnt += (uint32_t) __builtin_popcount(urb_sender->queued_mask[lane]);
+                urb_sender->free_mask |= urb_sender->queued_mask[lane];
+                urb_sender->queued_mask[lane] = 0U;
+            }
+            for (uint8_t i = 0U; i < URB_SENDER_COALESCE_KEYS; i++) {
+                urb_sender->queued_by_key[i] = URB_SENDER_NO_PACKET;
+            }
+            CD_EXIT_CRITICAL();
+        }
+    }
+    return status;
+}
+
+URBSender_StatusTypeDef urb_sender_wait_event(urb_sender_t *urb_sender, TickType_t timeout) {
+    URBSender_StatusTypeDef status = URB_SENDER_ERROR;
+    if (urb_sender != NULL) {
+        if (urb_sender->tx_task == NULL) {
+            urb_sender->tx_task = xTaskGetCurrentTaskHandle();
         }
+        (void) ulTaskNotifyTake(pdTRUE, timeout);
+        status = URB_SENDER_OK;
     }
     return status;
 }
+
+void urb_sender_notify_from_isr(urb_sender_t *urb_sender, uint8_t pipe_num) {
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    if ((urb_sender != NULL) && (urb_sender->tx_task != NULL) &&
+        (pipe_num < URB_SENDER_MAX_PIPES) && (urb_sender->in_flight[pipe_num] != URB_SENDER_NO_PACKET)) {
+        vTaskNotifyGiveFromISR(urb_sender->tx_task, &higher_priority_task_woken);
+    }
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+URBSender_StatusTypeDef urb_sender_get_stats(const urb_sender_t *urb_sender, urb_sender_stats_t *stats) {
+    URBSender_StatusTypeDef status = URB_SENDER_ERROR;
+    if ((urb_sender != NULL) && (stats != NULL)) {
+        CD_ENTER_CRITICAL();
+        (void) memcpy(stats, &urb_sender->stats, sizeof(*stats));
+        CD_EXIT_CRITICAL();
+        status = URB_SENDER_OK;
+    }
+    return status;
+}
+
+uint8_t urb_sender_get_pending_count(const urb_sender_t *urb_sender) {
+    uint32_t pending_mask = 0U;
+    if (urb_sender != NULL) {
+        CD_ENTER_CRITICAL();
+        for (uint8_t lane = 0U; lane < URB_SENDER_LANE_COUNT; lane++) {
+            pending_mask |= urb_sender->queued_mask[lane];
+        }
+        CD_EXIT_CRITICAL();
+        for (uint8_t pipe = 0U; pipe < URB_SENDER_MAX_PIPES; pipe++) {
+            if (urb_sender->in_flight[pipe] != URB_SENDER_NO_PACKET) {
+                pending_mask |= (1UL << urb_sender->in_flight[pipe]);
+            }
+        }
+    }
+    return (uint8_t) __builtin_popcount(pending_mask);
+}
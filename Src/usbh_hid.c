@@ -70,6 +70,8 @@
 /** @defgroup USBH_HID_CORE_Private_Defines
  * @{
  */
+/* Flag of the latest slot of a triple buffer holding a report not read yet */
+#define HID_REPORT_RING_NEW                         0x80U
 /**
  * @}
  */
@@ -455,11 +457,19 @@ static USBH_StatusTypeDef USBH_HID_Process(USBH_HandleTypeDef *phost) {
 			XferSize = USBH_LL_GetLastXferSize(phost, HID_Handle->InPipe);
 
 			if ((HID_Handle->DataReady == 0U) && (XferSize != 0U)
-					&& (HID_Handle->fifo.buf != NULL)) {
-				(void) USBH_HID_FifoWrite(&HID_Handle->fifo, HID_Handle->pData,
-						HID_Handle->length);
+					&& ((HID_Handle->report_ring.slots != NULL)
+							|| (HID_Handle->fifo.buf != NULL))) {
+				if (HID_Handle->report_ring.slots != NULL) {
+					(void) USBH_HID_ReportRingWrite(&HID_Handle->report_ring,
+							HID_Handle->pData, HID_Handle->length);
+				} else {
+					(void) USBH_HID_FifoWrite(&HID_Handle->fifo, HID_Handle->pData,
+							HID_Handle->length);
+				}
 				HID_Handle->DataReady = 1U;
+				HID_Handle->InEventCallback = 1U;
 				USBH_HID_EventCallback(phost);
+				HID_Handle->InEventCallback = 0U;
 
 #if (USBH_USE_OS == 1U)
 				phost->os_msg = (uint32_t) USBH_URB_EVENT;
@@ -850,6 +860,107 @@ uint16_t USBH_HID_FifoWrite(FIFO_TypeDef *f, void *buf, uint16_t nbytes) {
 	return nbytes;
 }
 
+/**
+ * @brief  USBH_HID_ReportRingInit
+ *         Initialize a report ring.
+ * @param  r: Ring address
+ * @param  buf: Slot buffer, HID_REPORT_RING_SIZE slots in queue mode,
+ *         HID_REPORT_LATEST_SLOTS slots in latest report mode
+ * @param  slot_size: Size of a slot, the largest report
+ * @param  latest_only: 1 for the latest report mode, 0 for the queue mode
+ * @retval none
+ */
+void USBH_HID_ReportRingInit(HID_ReportRingTypeDef *r, uint8_t *buf,
+		uint16_t slot_size, uint8_t latest_only) {
+	(void) USBH_memset(r, 0, sizeof(HID_ReportRingTypeDef));
+	r->slot_size = slot_size;
+	r->latest_only = latest_only;
+	/* Triple buffer: the writer owns slot 0, the reader slot 1, slot 2 is shared */
+	r->write_slot = 0U;
+	r->read_slot = 1U;
+	r->latest_slot = 2U;
+	r->slots = buf;
+}
+
+/**
+ * @brief  USBH_HID_ReportRingRead
+ *         Read a whole report from a report ring.
+ *         Only the consumer may call it.
+ * @param  r: Ring address
+ * @param  buf: read buffer
+ * @param  nbytes: size of the read buffer
+ * @retval number of bytes of the report read, 0 if there is no new report
+ */
+uint16_t USBH_HID_ReportRingRead(HID_ReportRingTypeDef *r, void *buf, uint16_t nbytes) {
+	uint16_t len = 0U;
+	uint8_t slot = HID_REPORT_RING_SIZE;
+
+	if (r->latest_only != 0U) {
+		if ((__atomic_load_n(&r->latest_slot, __ATOMIC_ACQUIRE) & HID_REPORT_RING_NEW) != 0U) {
+			/* Hand the slot just read back to the writer, take the newest one */
+			slot = __atomic_exchange_n(&r->latest_slot, r->read_slot, __ATOMIC_ACQ_REL)
+					& (uint8_t) ~HID_REPORT_RING_NEW;
+			r->read_slot = slot;
+		}
+	} else if (__atomic_load_n(&r->head, __ATOMIC_ACQUIRE) != r->tail) {
+		slot = (uint8_t) (r->tail & (HID_REPORT_RING_SIZE - 1U));
+	}
+
+	if (slot < HID_REPORT_RING_SIZE) {
+		len = (r->length[slot] < nbytes) ? r->length[slot] : nbytes;
+		(void) USBH_memcpy(buf, &r->slots[slot * r->slot_size], len);
+		if (r->latest_only == 0U) {
+			__atomic_store_n(&r->tail, r->tail + 1U, __ATOMIC_RELEASE);
+		}
+	}
+
+	return len;
+}
+
+/**
+ * @brief  USBH_HID_ReportRingWrite
+ *         Write a whole report to a report ring.
+ *         Only the producer may call it.
+ * @param  r: Ring address
+ * @param  buf: report
+ * @param  nbytes: report length, truncated to the slot size
+ * @retval number of bytes written, 0 if the report was dropped
+ */
+uint16_t USBH_HID_ReportRingWrite(HID_ReportRingTypeDef *r, const void *buf, uint16_t nbytes) {
+	const uint16_t len = (nbytes < r->slot_size) ? nbytes : r->slot_size;
+	uint16_t written = 0U;
+
+	if (r->latest_only != 0U) {
+		uint8_t slot = r->write_slot;
+
+		r->length[slot] = len;
+		(void) USBH_memcpy(&r->slots[slot * r->slot_size], buf, len);
+		/* Publish the slot, the previous one becomes the next write slot */
+		slot = __atomic_exchange_n(&r->latest_slot, slot | HID_REPORT_RING_NEW, __ATOMIC_ACQ_REL);
+		if ((slot & HID_REPORT_RING_NEW) != 0U) {
+			/* The previous report was never read */
+			r->overrun_cnt++;
+		}
+		r->write_slot = slot & (uint8_t) ~HID_REPORT_RING_NEW;
+		written = len;
+	} else {
+		const uint32_t head = r->head;
+
+		if ((head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE)) < HID_REPORT_RING_SIZE) {
+			const uint8_t slot = (uint8_t) (head & (HID_REPORT_RING_SIZE - 1U));
+
+			r->length[slot] = len;
+			(void) USBH_memcpy(&r->slots[slot * r->slot_size], buf, len);
+			__atomic_store_n(&r->head, head + 1U, __ATOMIC_RELEASE);
+			written = len;
+		} else {
+			r->overrun_cnt++;
+		}
+	}
+
+	return written;
+}
+
 /**
  * @brief  The function is a callback about HID Data events
  *  @param  phost: Selected device
@@ -47,6 +47,27 @@ EndBSPDependencies */
 /** @defgroup USBH_HID_PARSER_Private_TypesDefinitions
   * @{
   */
+/* Global items, saved and restored by Push and Pop */
+typedef struct
+{
+  uint16_t usage_page;
+  int32_t  logical_min;
+  uint32_t report_size;
+  uint32_t report_count;
+  uint8_t  report_id;
+}
+HID_Parser_GlobalTypedef;
+
+/* Local items, cleared after each main item */
+typedef struct
+{
+  uint32_t usages[HID_PARSER_MAX_USAGES];
+  uint8_t  usage_count;
+  uint32_t usage_min;
+  uint32_t usage_max;
+  uint8_t  has_range;
+}
+HID_Parser_LocalTypedef;
 /**
   * @}
   */
@@ -55,6 +76,32 @@ EndBSPDependencies */
 /** @defgroup USBH_HID_PARSER_Private_Defines
   * @{
   */
+/* Short item prefixes, without the size bits */
+#define HID_ITEM_INPUT                 0x80U
+#define HID_ITEM_OUTPUT                0x90U
+#define HID_ITEM_FEATURE               0xB0U
+#define HID_ITEM_COLLECTION            0xA0U
+#define HID_ITEM_END_COLLECTION        0xC0U
+#define HID_ITEM_USAGE_PAGE            0x04U
+#define HID_ITEM_LOGICAL_MIN           0x14U
+#define HID_ITEM_REPORT_SIZE           0x74U
+#define HID_ITEM_REPORT_ID             0x84U
+#define HID_ITEM_REPORT_COUNT          0x94U
+#define HID_ITEM_PUSH                  0xA4U
+#define HID_ITEM_POP                   0xB4U
+#define HID_ITEM_USAGE                 0x08U
+#define HID_ITEM_USAGE_MIN             0x18U
+#define HID_ITEM_USAGE_MAX             0x28U
+#define HID_ITEM_LONG                  0xFEU
+
+/* Main item flags */
+#define HID_MAIN_CONSTANT              0x01U
+#define HID_MAIN_VARIABLE              0x02U
+
+/* Widest field an extraction step can read */
+#define HID_EXTRACT_MAX_WIDTH          16U
+/* Bytes read by an extraction step */
+#define HID_EXTRACT_LOAD_BYTES         3U
 /**
   * @}
   */
@@ -223,6 +270,305 @@ uint32_t HID_WriteItem(HID_Report_ItemTypedef *ri, uint32_t value, uint8_t ndx)
   return 0U;
 }
 
+/**
+  * @brief  HID_ItemData
+  *         The function returns the unsigned data of a short item.
+  * @param  data: first data byte
+  * @param  size: number of data bytes
+  * @retval item data
+  */
+static uint32_t HID_ItemData(const uint8_t *data, uint8_t size)
+{
+  uint32_t val = 0U;
+  uint8_t x;
+
+  for (x = 0U; x < size; x++)
+  {
+    val |= (uint32_t)data[x] << (x * 8U);
+  }
+  return val;
+}
+
+/**
+  * @brief  HID_ItemSignedData
+  *         The function returns the sign extended data of a short item.
+  * @param  data: first data byte
+  * @param  size: number of data bytes
+  * @retval item data
+  */
+static int32_t HID_ItemSignedData(const uint8_t *data, uint8_t size)
+{
+  uint32_t val = HID_ItemData(data, size);
+
+  if ((size > 0U) && (size < 4U) && ((val & (1UL << ((size * 8U) - 1U))) != 0U))
+  {
+    val |= 0xFFFFFFFFUL << (size * 8U);
+  }
+  return (int32_t)val;
+}
+
+/**
+  * @brief  HID_LocalUsage
+  *         The function returns the usage of the n-th field of a main item.
+  * @param  local: local items of the main item
+  * @param  ndx: field index
+  * @retval extended usage, 0 if none
+  */
+static uint32_t HID_LocalUsage(const HID_Parser_LocalTypedef *local, uint32_t ndx)
+{
+  uint32_t usage = 0U;
+
+  if (local->usage_count > 0U)
+  {
+    /* The last usage applies to the remaining fields */
+    usage = local->usages[(ndx < local->usage_count) ? ndx : (local->usage_count - 1U)];
+  }
+  else if (local->has_range != 0U)
+  {
+    usage = ((local->usage_min + ndx) <= local->usage_max) ? (local->usage_min + ndx) : local->usage_max;
+  }
+  return usage;
+}
+
+/**
+  * @brief  HID_CompileReportDesc
+  *         The function parses a report descriptor into an extraction plan.
+  *         Every variable input field whose usage is listed in the map
+  *         becomes one step. Only the input report with the first report
+  *         ID met is planned; fields wider than 16 bits and fields with a
+  *         negative logical minimum are not supported and are skipped, as
+  *         are the fields whose load would end past report_length or start
+  *         past byte 255. More than HID_EXTRACT_MAX_STEPS fields fail.
+  * @param  desc: report descriptor
+  * @param  length: report descriptor length
+  * @param  map: destinations of the usages
+  * @param  map_count: number of map entries
+  * @param  report_length: size of the report buffer given to HID_ExtractReport
+  * @param  plan: plan to be filled
+  * @retval USBH Status, USBH_FAIL if the descriptor is malformed or no field is planned
+  */
+USBH_StatusTypeDef HID_CompileReportDesc(const uint8_t *desc, uint16_t length,
+                                         const HID_Usage_MapTypedef *map, uint8_t map_count,
+                                         uint16_t report_length, HID_Extract_PlanTypedef *plan)
+{
+  HID_Parser_GlobalTypedef global = {0};
+  HID_Parser_GlobalTypedef stack[HID_PARSER_STACK_DEPTH];
+  HID_Parser_LocalTypedef local = {0};
+  uint8_t stack_depth = 0U;
+  uint8_t report_id_set = 0U;
+  uint32_t bit_offset = 0U;
+  uint32_t pos = 0U;
+  USBH_StatusTypeDef status = USBH_OK;
+
+  if ((desc == NULL) || (map == NULL) || (plan == NULL))
+  {
+    return USBH_FAIL;
+  }
+
+  plan->count = 0U;
+  plan->report_id = 0U;
+
+  while ((pos < length) && (status == USBH_OK))
+  {
+    const uint8_t prefix = desc[pos];
+    const uint8_t size = ((prefix & 0x03U) == 0x03U) ? 4U : (prefix & 0x03U);
+
+    if (prefix == HID_ITEM_LONG)
+    {
+      /* Long items carry their data size in the next byte */
+      pos += (pos + 1U < length) ? (desc[pos + 1U] + 3U) : 1U;
+      continue;
+    }
+    if ((pos + 1U + size) > length)
+    {
+      status = USBH_FAIL;
+      break;
+    }
+
+    const uint8_t *data = &desc[pos + 1U];
+    const uint32_t val = HID_ItemData(data, size);
+
+    switch (prefix & 0xFCU)
+    {
+      case HID_ITEM_USAGE_PAGE:
+        global.usage_page = (uint16_t)val;
+        break;
+
+      case HID_ITEM_LOGICAL_MIN:
+        global.logical_min = HID_ItemSignedData(data, size);
+        break;
+
+      case HID_ITEM_REPORT_SIZE:
+        global.report_size = val;
+        break;
+
+      case HID_ITEM_REPORT_COUNT:
+        global.report_count = val;
+        break;
+
+      case HID_ITEM_REPORT_ID:
+        global.report_id = (uint8_t)val;
+        if (report_id_set == 0U)
+        {
+          /* The report ID takes the first byte of the report */
+          report_id_set = 1U;
+          plan->report_id = global.report_id;
+          bit_offset = 8U;
+        }
+        break;
+
+      case HID_ITEM_PUSH:
+        if (stack_depth < HID_PARSER_STACK_DEPTH)
+        {
+          stack[stack_depth] = global;
+          stack_depth++;
+        }
+        else
+        {
+          status = USBH_FAIL;
+        }
+        break;
+
+      case HID_ITEM_POP:
+        if (stack_depth > 0U)
+        {
+          stack_depth--;
+          global = stack[stack_depth];
+        }
+        else
+        {
+          status = USBH_FAIL;
+        }
+        break;
+
+      case HID_ITEM_USAGE:
+        if (local.usage_count < HID_PARSER_MAX_USAGES)
+        {
+          local.usages[local.usage_count] = (size == 4U) ? val : HID_EXTENDED_USAGE(global.usage_page, val);
+          local.usage_count++;
+        }
+        break;
+
+      case HID_ITEM_USAGE_MIN:
+        local.usage_min = (size == 4U) ? val : HID_EXTENDED_USAGE(global.usage_page, val);
+        local.has_range = 1U;
+        break;
+
+      case HID_ITEM_USAGE_MAX:
+        local.usage_max = (size == 4U) ? val : HID_EXTENDED_USAGE(global.usage_page, val);
+        local.has_range = 1U;
+        break;
+
+      case HID_ITEM_INPUT:
+        if (global.report_id == plan->report_id)
+        {
+          const uint64_t item_bits = (uint64_t)global.report_size * global.report_count;
+
+          if (((val & (HID_MAIN_CONSTANT | HID_MAIN_VARIABLE)) == HID_MAIN_VARIABLE) &&
+              (global.report_size > 0U) && (global.report_size <= HID_EXTRACT_MAX_WIDTH) &&
+              (global.logical_min >= 0))
+          {
+            /* Field offsets only grow: the loop ends at the first field out of the report */
+            for (uint32_t i = 0U; (i < global.report_count) && (status == USBH_OK); i++)
+            {
+              const uint64_t byte_offset = ((uint64_t)bit_offset + ((uint64_t)i * global.report_size)) / 8U;
+              const uint32_t usage = HID_LocalUsage(&local, i);
+
+              if (((byte_offset + HID_EXTRACT_LOAD_BYTES) > report_length) || (byte_offset > UINT8_MAX))
+              {
+                break;
+              }
+
+              for (uint8_t m = 0U; m < map_count; m++)
+              {
+                if (map[m].usage == usage)
+                {
+                  if (plan->count >= HID_EXTRACT_MAX_STEPS)
+                  {
+                    status = USBH_FAIL;
+                    break;
+                  }
+                  HID_Extract_StepTypedef *step = &plan->steps[plan->count];
+                  step->byte_offset = (uint8_t)byte_offset;
+                  step->shift = (uint8_t)((bit_offset + (i * global.report_size)) % 8U);
+                  step->dest_offset = map[m].dest_offset;
+                  step->dest_size = map[m].dest_size;
+                  step->mask = (uint16_t)((1UL << global.report_size) - 1UL);
+                  step->max = map[m].max;
+                  plan->count++;
+                  break;
+                }
+              }
+            }
+          }
+          /* Saturated, so that a huge item cannot wrap the offset of the next ones */
+          bit_offset = (item_bits > (uint64_t)(UINT32_MAX - bit_offset)) ? UINT32_MAX : (bit_offset + (uint32_t)item_bits);
+        }
+        (void)memset(&local, 0, sizeof(local));
+        break;
+
+      case HID_ITEM_OUTPUT:
+      case HID_ITEM_FEATURE:
+      case HID_ITEM_COLLECTION:
+      case HID_ITEM_END_COLLECTION:
+        (void)memset(&local, 0, sizeof(local));
+        break;
+
+      default:
+        break;
+    }
+
+    pos += 1U + size;
+  }
+
+  if ((status != USBH_OK) || (plan->count == 0U))
+  {
+    plan->count = 0U;
+    status = USBH_FAIL;
+  }
+  return status;
+}
+
+/**
+  * @brief  HID_ExtractReport
+  *         The function runs an extraction plan on an input report.
+  * @param  plan: extraction plan
+  * @param  report: report buffer, at least report_length bytes
+  * @param  dest: decoded device structure
+  * @retval status (1: done / 0: report not matching the plan)
+  */
+uint8_t HID_ExtractReport(const HID_Extract_PlanTypedef *plan, const uint8_t *report, uint8_t *dest)
+{
+  const HID_Extract_StepTypedef *step = plan->steps;
+  const HID_Extract_StepTypedef *const end = &plan->steps[plan->count];
+
+  if ((plan->report_id != 0U) && (report[0] != plan->report_id))
+  {
+    return 0U;
+  }
+
+  for (; step < end; step++)
+  {
+    const uint8_t *data = &report[step->byte_offset];
+    uint32_t val = (((uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16)) >> step->shift) & step->mask;
+
+    if (val > step->max)
+    {
+      val = step->max;
+    }
+    if (step->dest_size == 1U)
+    {
+      dest[step->dest_offset] = (uint8_t)val;
+    }
+    else
+    {
+      const uint16_t val16 = (uint16_t)val;
+      (void)memcpy(&dest[step->dest_offset], &val16, sizeof(val16));
+    }
+  }
+  return 1U;
+}
+
 /**
   * @}
   */
@@ -1,199 +1,171 @@
 /* Includes ------------------------------------------------------------------*/
 #include "usbh_hid_t818.h"
 #include "usbh_hid_parser.h"
+#include <stddef.h>
+
+/* Sums of the axes over the reports read by one USBH_HID_GetT818Info() call */
+typedef struct {
+  uint32_t wheel_rotation;
+  uint32_t brake;
+  uint32_t throttle;
+  uint32_t clutch;
+  uint32_t vx_axis;
+  uint32_t vy_axis;
+  uint32_t rx_axis;
+  uint32_t ry_axis;
+  uint32_t z_axis;
+} HID_T818_AxisSumTypeDef;
 
 static USBH_StatusTypeDef USBH_HID_T818Decode(USBH_HandleTypeDef *phost);
+static void USBH_HID_T818CompilePlan(USBH_HandleTypeDef *phost);
+static void USBH_HID_T818DecodeFixed(void);
+static uint8_t USBH_HID_T818ReportChanged(void);
+static void USBH_HID_T818Reduce(const HID_T818_AxisSumTypeDef *sum, uint16_t report_cnt,
+                                uint32_t pressed, uint32_t released);
 
 static HID_T818_Info_TypeDef t818_info;
 
+/* Values of the last report read, reduced into t818_info once per call of
+ * USBH_HID_GetT818Info() */
+static HID_T818_Info_TypeDef t818_sample;
+
 uint8_t t818_report_data[T818_REPORT_SIZE];
 uint8_t t818_rx_report_buf[T818_REPORT_SIZE];
 
-/* Structures defining how to access items in a HID T818 report */
-
-/* Access x coordinate change. */
-static const HID_Report_ItemTypedef x_axis_state =
-{
-  t818_report_data + 1, /*data*/
-  16,     /*size*/
-  0,     /*shift*/
-  0,     /*count (only for array items)*/
-  0,     /*signed?*/
-  T818_WHEEL_ROTATION_MIN,     /*min value read can return*/
-  T818_WHEEL_ROTATION_MAX,     /*max value read can return*/
-  T818_WHEEL_ROTATION_MIN,     /*min value device can report*/
-  T818_WHEEL_ROTATION_MAX,     /*max value device can report*/
-  1      /*resolution*/
+/* Layout of a HID T818 report.
+ * The fields sit at fixed offsets, so when the report descriptor could not be
+ * compiled they are read with direct little endian loads instead of going
+ * through the generic HID_ReadItem(). */
+
+/** @brief Offset of the X axis, wheel rotation, 16 bits */
+#define T818_X_AXIS_OFFSET            (1U)
+/** @brief Offset of the Y axis, brake, 16 bits */
+#define T818_Y_AXIS_OFFSET            (3U)
+/** @brief Offset of the Rz axis, throttle, 16 bits */
+#define T818_RZ_AXIS_OFFSET           (5U)
+/** @brief Offset of the slider axis, clutch, 16 bits */
+#define T818_SLIDER_AXIS_OFFSET       (7U)
+/** @brief Offset of the Vx axis, 8 bits */
+#define T818_VX_AXIS_OFFSET           (9U)
+/** @brief Offset of the Vy axis, 8 bits */
+#define T818_VY_AXIS_OFFSET           (10U)
+/** @brief Offset of the Rx axis, 8 bits */
+#define T818_RX_AXIS_OFFSET           (11U)
+/** @brief Offset of the Ry axis, 8 bits */
+#define T818_RY_AXIS_OFFSET           (12U)
+/** @brief Offset of the Z axis, 8 bits */
+#define T818_Z_AXIS_OFFSET            (13U)
+/** @brief Offset of the first button byte, the buttons span 4 bytes */
+#define T818_BUTTONS_OFFSET           (15U)
+/** @brief Offset of the arrow pad, low nibble */
+#define T818_PAD_ARROW_OFFSET         (19U)
+/** @brief Number of report bytes read by the fixed decoder */
+#define T818_FIXED_REPORT_EXTENT      (T818_PAD_ARROW_OFFSET + 1U)
+
+/** @brief Number of 64-bit words of a report */
+#define T818_REPORT_WORDS             (T818_REPORT_SIZE / 8U)
+
+/* Position of each button in the 32-bit little endian word starting at
+ * T818_BUTTONS_OFFSET, indexed by button ID. */
+static const uint8_t button_bit_positions[BUTTON_COUNT] = {
+	[BUTTON_PADDLE_SHIFTER_LEFT] = 0U,
+	[BUTTON_PADDLE_SHIFTER_RIGHT] = 1U,
+	[BUTTON_DRINK] = 2U,
+	[BUTTON_RADIO] = 3U,
+	[BUTTON_ONE_PLUS] = 4U,
+	[BUTTON_TEN_MINUS] = 5U,
+	[BUTTON_SHA] = 6U,
+	[BUTTON_OIL] = 7U,
+	[BUTTON_PARKING] = 8U,
+	[BUTTON_NEUTRAL] = 9U,
+	[BUTTON_K1] = 10U,
+	[BUTTON_K2] = 11U,
+	[BUTTON_S1] = 12U,
+	[BUTTON_LEFT_SIDE_WHEEL_UP] = 13U,
+	[BUTTON_LEFT_SIDE_WHEEL_DOWN] = 14U,
+	[BUTTON_RIGHT_SIDE_WHEEL_UP] = 16U,
+	[BUTTON_RIGHT_SIDE_WHEEL_DOWN] = 15U,
+	[BUTTON_GRIP_ANTICLOCKWISE] = 17U,
+	[BUTTON_GRIP_CLOCKWISE] = 18U,
+	[BUTTON_ENG_ANTICLOCKWISE] = 19U,
+	[BUTTON_ENG_CLOCKWISE] = 20U,
+	[BUTTON_22] = 21U,
+	[BUTTON_23] = 22U,
+	[BUTTON_GRIP] = 23U,
+	[BUTTON_ENG] = 24U
 };
 
-/* Access y coordinate change. */
-static const HID_Report_ItemTypedef y_axis_state =
-{
-  t818_report_data + 3, /*data*/
-  16,     /*size*/
-  0,     /*shift*/
-  0,     /*count (only for array items)*/
-  0,     /*signed?*/
-  T818_BRAKE_MIN,     /*min value read can return*/
-  T818_BRAKE_MAX,     /*max value read can return*/
-  T818_BRAKE_MIN,     /*min value device can report*/
-  T818_BRAKE_MAX,     /*max value device can report*/
-  1      /*resolution*/
+/** @brief Generic Desktop usage page */
+#define T818_USAGE_PAGE_GENERIC_DESKTOP  (0x01U)
+/** @brief Button usage page, usage n is button bit n - 1 */
+#define T818_USAGE_PAGE_BUTTON           (0x09U)
+
+/** @brief Number of entries of the usage map */
+#define T818_USAGE_MAP_SIZE              (10U + BUTTON_COUNT)
+
+/* Destination in t818_info of each axis usage, the buttons are appended at
+ * init from button_bit_positions. */
+static const HID_Usage_MapTypedef t818_axis_map[] = {
+	{ HID_EXTENDED_USAGE(T818_USAGE_PAGE_GENERIC_DESKTOP, 0x30U), offsetof(HID_T818_Info_TypeDef, wheel_rotation), 2U, T818_WHEEL_ROTATION_MAX },
+	{ HID_EXTENDED_USAGE(T818_USAGE_PAGE_GENERIC_DESKTOP, 0x31U), offsetof(HID_T818_Info_TypeDef, brake), 2U, T818_BRAKE_MAX },
+	{ HID_EXTENDED_USAGE(T818_USAGE_PAGE_GENERIC_DESKTOP, 0x35U), offsetof(HID_T818_Info_TypeDef, throttle), 2U, T818_THROTTLE_MAX },
+	{ HID_EXTENDED_USAGE(T818_USAGE_PAGE_GENERIC_DESKTOP, 0x36U), offsetof(HID_T818_Info_TypeDef, clutch), 2U, T818_CLUTCH_MAX },
+	{ HID_EXTENDED_USAGE(T818_USAGE_PAGE_GENERIC_DESKTOP, 0x40U), offsetof(HID_T818_Info_TypeDef, vx_axis), 1U, T818_VX_AXIS_MAX },
+	{ HID_EXTENDED_USAGE(T818_USAGE_PAGE_GENERIC_DESKTOP, 0x41U), offsetof(HID_T818_Info_TypeDef, vy_axis), 1U, T818_VY_AXIS_MAX },
+	{ HID_EXTENDED_USAGE(T818_USAGE_PAGE_GENERIC_DESKTOP, 0x33U), offsetof(HID_T818_Info_TypeDef, rx_axis), 1U, T818_RX_AXIS_MAX },
+	{ HID_EXTENDED_USAGE(T818_USAGE_PAGE_GENERIC_DESKTOP, 0x34U), offsetof(HID_T818_Info_TypeDef, ry_axis), 1U, T818_RY_AXIS_MAX },
+	{ HID_EXTENDED_USAGE(T818_USAGE_PAGE_GENERIC_DESKTOP, 0x32U), offsetof(HID_T818_Info_TypeDef, z_axis), 1U, T818_Z_AXIS_MAX },
+	{ HID_EXTENDED_USAGE(T818_USAGE_PAGE_GENERIC_DESKTOP, 0x39U), offsetof(HID_T818_Info_TypeDef, pad_arrow), 1U, T818_PAD_ARROW_MAX }
 };
 
-/* Access rz coordinate change. */
-static const HID_Report_ItemTypedef rz_axis_state =
-{
-  t818_report_data + 5, /*data*/
-  16,     /*size*/
-  0,     /*shift*/
-  0,     /*count (only for array items)*/
-  0,     /*signed?*/
-  T818_THROTTLE_MIN,     /*min value read can return*/
-  T818_THROTTLE_MAX,     /*max value read can return*/
-  T818_THROTTLE_MIN,     /*min value device can report*/
-  T818_THROTTLE_MAX,     /*max value device can report*/
-  1      /*resolution*/
-};
+/* Extraction plan compiled from the report descriptor at init, empty when the
+ * descriptor could not be compiled. */
+static HID_Extract_PlanTypedef t818_plan;
 
-/* Access slider coordinate change. */
-static const HID_Report_ItemTypedef slider_axis_state =
-{
-  t818_report_data + 7, /*data*/
-  16,     /*size*/
-  0,     /*shift*/
-  0,     /*count (only for array items)*/
-  0,     /*signed?*/
-  T818_CLUTCH_MIN,     /*min value read can return*/
-  T818_CLUTCH_MAX,     /*max value read can return*/
-  T818_CLUTCH_MIN,     /*min value device can report*/
-  T818_CLUTCH_MAX,     /*max value device can report*/
-  1      /*resolution*/
-};
+/* Decoded bytes of the last report, compared word by word with each new
+ * report so that an unchanged report is not decoded again. */
+static uint64_t t818_last_report[T818_REPORT_WORDS];
 
-/* Access vx coordinate change. */
-static const HID_Report_ItemTypedef vx_axis_state =
-{
-  t818_report_data + 9, /*data*/
-  8,     /*size*/
-  0,     /*shift*/
-  0,     /*count (only for array items)*/
-  0,     /*signed?*/
-  T818_VX_AXIS_MIN,     /*min value read can return*/
-  T818_VX_AXIS_MAX,     /*max value read can return*/
-  T818_VX_AXIS_MIN,     /*min value device can report*/
-  T818_VX_AXIS_MAX,     /*max value device can report*/
-  1      /*resolution*/
-};
+/* Number of words of t818_last_report covering the decoded fields */
+static uint8_t t818_report_words;
 
-/* Access vy coordinate change. */
-static const HID_Report_ItemTypedef vy_axis_state =
-{
-  t818_report_data + 10, /*data*/
-  8,     /*size*/
-  0,     /*shift*/
-  0,     /*count (only for array items)*/
-  0,     /*signed?*/
-  T818_VY_AXIS_MIN,     /*min value read can return*/
-  T818_VY_AXIS_MAX,     /*max value read can return*/
-  T818_VY_AXIS_MIN,     /*min value device can report*/
-  T818_VY_AXIS_MAX,     /*max value device can report*/
-  1      /*resolution*/
-};
+/* Buttons of the last report read, bit i being button ID i */
+static uint32_t t818_sample_buttons;
 
-/* Access rx coordinate change. */
-static const HID_Report_ItemTypedef rx_axis_state =
-{
-  t818_report_data + 11, /*data*/
-  8,     /*size*/
-  0,     /*shift*/
-  0,     /*count (only for array items)*/
-  0,     /*signed?*/
-  T818_RX_AXIS_MIN,     /*min value read can return*/
-  T818_RX_AXIS_MAX,     /*max value read can return*/
-  T818_RX_AXIS_MIN,     /*min value device can report*/
-  T818_RX_AXIS_MAX,     /*max value device can report*/
-  1      /*resolution*/
-};
+/* Buttons pressed again after a release hidden in the same step, reported
+ * pressed at the next call */
+static uint32_t t818_pending_presses;
 
-/* Access ry coordinate change. */
-static const HID_Report_ItemTypedef ry_axis_state =
+/**
+  * @brief  Loads a little endian 16-bit field of the report.
+  * @param  data: first byte of the field
+  * @retval Field value
+  */
+static inline uint16_t __load_le16(const uint8_t *data)
 {
-  t818_report_data + 12, /*data*/
-  8,     /*size*/
-  0,     /*shift*/
-  0,     /*count (only for array items)*/
-  0,     /*signed?*/
-  T818_RY_AXIS_MIN,     /*min value read can return*/
-  T818_RY_AXIS_MAX,     /*max value read can return*/
-  T818_RY_AXIS_MIN,     /*min value device can report*/
-  T818_RY_AXIS_MAX,     /*max value device can report*/
-  1      /*resolution*/
-};
+  return (uint16_t)((uint16_t)data[0] | ((uint16_t)data[1] << 8));
+}
 
-/* Access z coordinate change. */
-static const HID_Report_ItemTypedef z_axis_state =
+/**
+  * @brief  Loads a little endian 32-bit field of the report.
+  * @param  data: first byte of the field
+  * @retval Field value
+  */
+static inline uint32_t __load_le32(const uint8_t *data)
 {
-  t818_report_data + 13, /*data*/
-  8,     /*size*/
-  0,     /*shift*/
-  0,     /*count (only for array items)*/
-  0,     /*signed?*/
-  T818_Z_AXIS_MIN,     /*min value read can return*/
-  T818_Z_AXIS_MAX,     /*max value read can return*/
-  T818_Z_AXIS_MIN,     /*min value device can report*/
-  T818_Z_AXIS_MAX,     /*max value device can report*/
-  1      /*resolution*/
-};
+  return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
 
-/* Access arrow pad state. */
-static const HID_Report_ItemTypedef pad_arrow_state =
+/**
+  * @brief  Clamps an axis to its logical maximum, as HID_ReadItem() does.
+  * @param  value: raw axis value
+  * @param  max: logical maximum of the axis
+  * @retval Clamped value
+  */
+static inline uint16_t __clamp_axis(uint16_t value, uint16_t max)
 {
-  t818_report_data + 19, /*data*/
-  4,     /*size*/
-  0,     /*shift*/
-  0,     /*count (only for array items)*/
-  0,     /*signed?*/
-  T818_PAD_ARROW_MIN,     /*min value read can return*/
-  T818_PAD_ARROW_MAX,     /*max value read can return*/
-  T818_PAD_ARROW_MIN,     /*min value device can report*/
-  T818_PAD_ARROW_MAX,     /*max value device can report*/
-  1      /*resolution*/
-};
-
-/* Define button states mapping */
-typedef struct {
-	uint8_t index;
-	HID_Report_ItemTypedef report_item;
-} ButtonReportConfig;
-
-static const ButtonReportConfig button_report_configs[BUTTON_COUNT] = {
-	{BUTTON_PADDLE_SHIFTER_LEFT, {t818_report_data + 15, 1, 0, 0, 0, 0, 1, 0, 1, 1}},
-	{BUTTON_PADDLE_SHIFTER_RIGHT, {t818_report_data + 15, 1, 1, 0, 0, 0, 1, 0, 1, 1}},
-	{BUTTON_DRINK, {t818_report_data + 15, 1, 2, 0, 0, 0, 1, 0, 1, 1}},
-	{BUTTON_RADIO, {t818_report_data + 15, 1, 3, 0, 0, 0, 1, 0, 1, 1}},
-	{BUTTON_ONE_PLUS, {t818_report_data + 15, 1, 4, 0, 0, 0, 1, 0, 1, 1}},
-	{BUTTON_TEN_MINUS, {t818_report_data + 15, 1, 5, 0, 0, 0, 1, 0, 1, 1}},
-	{BUTTON_SHA, {t818_report_data + 15, 1, 6, 0, 0, 0, 1, 0, 1, 1}},
-	{BUTTON_OIL, {t818_report_data + 15, 1, 7, 0, 0, 0, 1, 0, 1, 1}},
-	{BUTTON_PARKING, {t818_report_data + 16, 1, 0, 0, 0, 0, 1, 0, 1, 1}},
-	{BUTTON_NEUTRAL, {t818_report_data + 16, 1, 1, 0, 0, 0, 1, 0, 1, 1}},
-	{BUTTON_K1, {t818_report_data + 16, 1, 2, 0, 0, 0, 1, 0, 1, 1}},
-	{BUTTON_K2, {t818_report_data + 16, 1, 3, 0, 0, 0, 1, 0, 1, 1}},
-	{BUTTON_S1, {t818_report_data + 16, 1, 4, 0, 0, 0, 1, 0, 1, 1}},
-	{BUTTON_LEFT_SIDE_WHEEL_UP, {t818_report_data + 16, 1, 5, 0, 0, 0, 1, 0, 1, 1}},
-	{BUTTON_LEFT_SIDE_WHEEL_DOWN, {t818_report_data + 16, 1, 6, 0, 0, 0, 1, 0, 1, 1}},
-	{BUTTON_RIGHT_SIDE_WHEEL_UP, {t818_report_data + 17, 1, 0, 0, 0, 0, 1, 0, 1, 1}},
-	{BUTTON_RIGHT_SIDE_WHEEL_DOWN, {t818_report_data + 16, 1, 7, 0, 0, 0, 1, 0, 1, 1}},
-	{BUTTON_GRIP_ANTICLOCKWISE, {t818_report_data + 17, 1, 1, 0, 0, 0, 1, 0, 1, 1}},
-	{BUTTON_GRIP_CLOCKWISE, {t818_report_data + 17, 1, 2, 0, 0, 0, 1, 0, 1, 1}},
-	{BUTTON_ENG_ANTICLOCKWISE, {t818_report_data + 17, 1, 3, 0, 0, 0, 1, 0, 1, 1}},
-	{BUTTON_ENG_CLOCKWISE, {t818_report_data + 17, 1, 4, 0, 0, 0, 1, 0, 1, 1}},
-	{BUTTON_22, {t818_report_data + 17, 1, 5, 0, 0, 0, 1, 0, 1, 1}},
-	{BUTTON_23, {t818_report_data + 17, 1, 6, 0, 0, 0, 1, 0, 1, 1}},
-	{BUTTON_GRIP, {t818_report_data + 17, 1, 7, 0, 0, 0, 1, 0, 1, 1}},
-	{BUTTON_ENG, {t818_report_data + 18, 1, 0, 0, 0, 0, 1, 0, 1, 1}}
-};
+  return (value > max) ? max : value;
+}
 
 /**
   * @}
@@ -217,6 +189,10 @@ USBH_StatusTypeDef USBH_HID_T818Init(USBH_HandleTypeDef *phost)
   USBH_StatusTypeDef status=USBH_FAIL;
 
   memset(&t818_info, 0, sizeof(HID_T818_Info_TypeDef));
+  memset(&t818_sample, 0, sizeof(HID_T818_Info_TypeDef));
+  t818_sample_buttons = 0U;
+  t818_pending_presses = 0U;
+  memset(t818_last_report, 0, sizeof(t818_last_report));
 
   for (i = 0U; i < (sizeof(t818_report_data)); i++)
   {
@@ -230,13 +206,18 @@ USBH_StatusTypeDef USBH_HID_T818Init(USBH_HandleTypeDef *phost)
   }
 
   HID_Handle->pData = t818_rx_report_buf;
-  if ((HID_QUEUE_SIZE * sizeof(t818_report_data)) > sizeof(phost->device.Data))
+
+  /* The report descriptor is still in phost->device.Data, reused below as the report slots */
+  USBH_HID_T818CompilePlan(phost);
+
+  if ((HID_REPORT_RING_SIZE * sizeof(t818_report_data)) > sizeof(phost->device.Data))
   {
 	  status=USBH_FAIL;
   }
   else
   {
-	  USBH_HID_FifoInit(&HID_Handle->fifo, phost->device.Data, HID_QUEUE_SIZE * sizeof(t818_report_data));
+	  USBH_HID_ReportRingInit(&HID_Handle->report_ring, phost->device.Data,
+	                          (uint16_t)sizeof(t818_report_data), T818_REPORT_LATEST_ONLY);
 	  status=USBH_OK;
   }
   return status;
@@ -245,10 +226,53 @@ USBH_StatusTypeDef USBH_HID_T818Init(USBH_HandleTypeDef *phost)
 USBH_StatusTypeDef USBH_HID_GetT818Info(USBH_HandleTypeDef *phost)
 {
 	USBH_StatusTypeDef status=USBH_FAIL;
+  HID_HandleTypeDef *HID_Handle = (HID_HandleTypeDef *) phost->pActiveClass->pData;
+  HID_T818_AxisSumTypeDef sum = {0};
+  uint16_t report_cnt = 0U;
+  uint32_t pressed = 0U;
+  uint32_t released = 0U;
+
+  /* The report ring has a single reader, the control step: a call from the
+   * event callback, run by the ring writer, would steal its reports */
+  const uint8_t is_reader = (HID_Handle->InEventCallback == 0U) ? 1U : 0U;
 
-  if (USBH_HID_T818Decode(phost) == USBH_OK)
+  /* Read every report received since the last call */
+  while ((is_reader != 0U) && (USBH_HID_T818Decode(phost) == USBH_OK))
   {
-    status=USBH_OK;
+    uint32_t buttons = 0U;
+
+    for (uint8_t i = 0U; i < BUTTON_COUNT; i++)
+    {
+      buttons |= (uint32_t)(t818_sample.buttons[i] & 1U) << i;
+    }
+    pressed |= buttons & ~t818_sample_buttons;
+    released |= ~buttons & t818_sample_buttons;
+    t818_sample_buttons = buttons;
+
+    sum.wheel_rotation += t818_sample.wheel_rotation;
+    sum.brake += t818_sample.brake;
+    sum.throttle += t818_sample.throttle;
+    sum.clutch += t818_sample.clutch;
+    sum.vx_axis += t818_sample.vx_axis;
+    sum.vy_axis += t818_sample.vy_axis;
+    sum.rx_axis += t818_sample.rx_axis;
+    sum.ry_axis += t818_sample.ry_axis;
+    sum.z_axis += t818_sample.z_axis;
+    report_cnt++;
+  }
+
+  if (is_reader == 0U)
+  {
+    status=USBH_BUSY;
+  }
+  else
+  {
+    /* Reduced even without new reports, to settle the buttons latched by the last call */
+    USBH_HID_T818Reduce(&sum, report_cnt, pressed, released);
+    if (report_cnt > 0U)
+    {
+      status=USBH_OK;
+    }
   }
 
   return status;
@@ -274,31 +298,203 @@ static USBH_StatusTypeDef USBH_HID_T818Decode(USBH_HandleTypeDef *phost)
   USBH_StatusTypeDef status=USBH_FAIL;
 
   /*Fill report */
-  if ((!(HID_Handle->length == 0U) || (HID_Handle->fifo.buf == NULL)) && (USBH_HID_FifoRead(&HID_Handle->fifo, &t818_report_data, HID_Handle->length) ==  HID_Handle->length))
+  if ((HID_Handle->length != 0U) && (USBH_HID_ReportRingRead(&HID_Handle->report_ring, t818_report_data, HID_Handle->length) == HID_Handle->length))
   {
 
-    /*Decode report */
-    t818_info.wheel_rotation = (uint16_t)HID_ReadItem((HID_Report_ItemTypedef *) &x_axis_state, 0U);
-    t818_info.brake = (uint16_t)HID_ReadItem((HID_Report_ItemTypedef *) &y_axis_state, 0U);
-    t818_info.throttle = (uint16_t)HID_ReadItem((HID_Report_ItemTypedef *) &rz_axis_state, 0U);
-    t818_info.clutch = (uint16_t)HID_ReadItem((HID_Report_ItemTypedef *) &slider_axis_state, 0U);
-    t818_info.vx_axis = (uint16_t)HID_ReadItem((HID_Report_ItemTypedef *) &vx_axis_state, 0U);
-    t818_info.vy_axis = (uint16_t)HID_ReadItem((HID_Report_ItemTypedef *) &vy_axis_state, 0U);
-    t818_info.rx_axis = (uint16_t)HID_ReadItem((HID_Report_ItemTypedef *) &rx_axis_state, 0U);
-    t818_info.ry_axis = (uint16_t)HID_ReadItem((HID_Report_ItemTypedef *) &ry_axis_state, 0U);
-    t818_info.z_axis = (uint16_t)HID_ReadItem((HID_Report_ItemTypedef *) &z_axis_state, 0U);
-
-    for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
-    	HID_Report_ItemTypedef * report_item = (HID_Report_ItemTypedef *) &button_report_configs[i].report_item;
-    	t818_info.buttons[button_report_configs[i].index] = (uint8_t)HID_ReadItem(report_item, 0U);
+    /*Decode report, only if the decoded bytes changed */
+    if (USBH_HID_T818ReportChanged() != 0U)
+    {
+      if (t818_plan.count > 0U)
+      {
+        (void)HID_ExtractReport(&t818_plan, t818_report_data, (uint8_t *)&t818_sample);
+      }
+      else
+      {
+        USBH_HID_T818DecodeFixed();
+      }
     }
 
-    t818_info.pad_arrow = (uint8_t)HID_ReadItem((HID_Report_ItemTypedef *) &pad_arrow_state, 0U);
-
     status= USBH_OK;
   }
 
   return status;
 }
 
+/**
+  * @brief  USBH_HID_T818Reduce
+  *         The function reduces the reports read since the last call into
+  *         t818_info. The axes and the arrow pad take the last values, or the
+  *         axes the average when T818_AXIS_AVERAGE is set. A button press or
+  *         release seen in any report is kept for one call: a button pressed
+  *         and released in between reads pressed, then released at the next
+  *         call, and a held button released and pressed again reads released,
+  *         then pressed.
+  * @param  sum: sums of the axes over the reports
+  * @param  report_cnt: number of reports read, 0 to only settle the buttons
+  * @param  pressed: buttons pressed in the reports, bit i being button ID i
+  * @param  released: buttons released in the reports, bit i being button ID i
+  * @retval None
+  */
+static void USBH_HID_T818Reduce(const HID_T818_AxisSumTypeDef *sum, uint16_t report_cnt,
+                                uint32_t pressed, uint32_t released)
+{
+  HID_T818_Info_TypeDef reduced = t818_info;
+
+  if (report_cnt > 0U)
+  {
+#if (T818_AXIS_AVERAGE == 1U)
+    reduced.wheel_rotation = (uint16_t)(sum->wheel_rotation / report_cnt);
+    reduced.brake = (uint16_t)(sum->brake / report_cnt);
+    reduced.throttle = (uint16_t)(sum->throttle / report_cnt);
+    reduced.clutch = (uint16_t)(sum->clutch / report_cnt);
+    reduced.vx_axis = (uint8_t)(sum->vx_axis / report_cnt);
+    reduced.vy_axis = (uint8_t)(sum->vy_axis / report_cnt);
+    reduced.rx_axis = (uint8_t)(sum->rx_axis / report_cnt);
+    reduced.ry_axis = (uint8_t)(sum->ry_axis / report_cnt);
+    reduced.z_axis = (uint8_t)(sum->z_axis / report_cnt);
+#else
+    (void)sum;
+    reduced.wheel_rotation = t818_sample.wheel_rotation;
+    reduced.brake = t818_sample.brake;
+    reduced.throttle = t818_sample.throttle;
+    reduced.clutch = t818_sample.clutch;
+    reduced.vx_axis = t818_sample.vx_axis;
+    reduced.vy_axis = t818_sample.vy_axis;
+    reduced.rx_axis = t818_sample.rx_axis;
+    reduced.ry_axis = t818_sample.ry_axis;
+    reduced.z_axis = t818_sample.z_axis;
+#endif
+    reduced.pad_arrow = t818_sample.pad_arrow;
+  }
+
+  for (uint8_t i = 0U; i < BUTTON_COUNT; i++)
+  {
+    const uint32_t bit = 1UL << i;
+    const uint8_t now = t818_sample.buttons[i];
+
+    if (t818_info.buttons[i] == 0U)
+    {
+      reduced.buttons[i] = ((now != 0U) || (((pressed | t818_pending_presses) & bit) != 0U)) ? 1U : 0U;
+      t818_pending_presses &= ~bit;
+    }
+    else if ((released & bit) != 0U)
+    {
+      reduced.buttons[i] = 0U;
+      if (((pressed & bit) != 0U) && (now == 0U))
+      {
+        t818_pending_presses |= bit;
+      }
+    }
+    else
+    {
+      reduced.buttons[i] = now;
+    }
+  }
+
+  /* The flag is kept until the reader clears it */
+  reduced.changed = t818_info.changed;
+  if (memcmp(&reduced, &t818_info, sizeof(reduced)) != 0)
+  {
+    reduced.changed = 1U;
+    t818_info = reduced;
+  }
+}
+
+/**
+  * @brief  USBH_HID_T818CompilePlan
+  *         The function compiles the report descriptor into the extraction plan.
+  *         On failure the plan is left empty and the fixed layout is decoded.
+  * @param  phost: Host handle
+  * @retval None
+  */
+static void USBH_HID_T818CompilePlan(USBH_HandleTypeDef *phost)
+{
+  HID_HandleTypeDef *HID_Handle = (HID_HandleTypeDef *) phost->pActiveClass->pData;
+  HID_Usage_MapTypedef map[T818_USAGE_MAP_SIZE];
+  uint8_t count = 0U;
+
+  for (uint8_t i = 0U; i < (sizeof(t818_axis_map) / sizeof(t818_axis_map[0])); i++)
+  {
+    map[count++] = t818_axis_map[i];
+  }
+  for (uint8_t i = 0U; i < BUTTON_COUNT; i++)
+  {
+    map[count].usage = HID_EXTENDED_USAGE(T818_USAGE_PAGE_BUTTON, button_bit_positions[i] + 1U);
+    map[count].dest_offset = (uint8_t)(offsetof(HID_T818_Info_TypeDef, buttons) + i);
+    map[count].dest_size = 1U;
+    map[count].max = 1U;
+    count++;
+  }
+
+  uint16_t extent = T818_FIXED_REPORT_EXTENT;
+
+  if ((HID_Handle->HID_Desc.wItemLength > sizeof(phost->device.Data)) ||
+      (HID_CompileReportDesc(phost->device.Data, HID_Handle->HID_Desc.wItemLength, map, count,
+                             (uint16_t)sizeof(t818_report_data), &t818_plan) != USBH_OK))
+  {
+    t818_plan.count = 0U;
+  }
+  else
+  {
+    /* Each step loads 3 bytes, the report ID byte is always compared */
+    extent = 1U;
+    for (uint8_t i = 0U; i < t818_plan.count; i++)
+    {
+      if ((t818_plan.steps[i].byte_offset + 3U) > extent)
+      {
+        extent = t818_plan.steps[i].byte_offset + 3U;
+      }
+    }
+  }
+  t818_report_words = (uint8_t)((extent + 7U) / 8U);
+}
+
+/**
+  * @brief  USBH_HID_T818ReportChanged
+  *         The function compares the decoded bytes of the report with the last
+  *         report, 64 bits at a time, and keeps them for the next comparison.
+  * @retval 1 if the report changed, 0 otherwise
+  */
+static uint8_t USBH_HID_T818ReportChanged(void)
+{
+  uint8_t changed = 0U;
+  uint64_t word;
+
+  for (uint8_t i = 0U; i < t818_report_words; i++)
+  {
+    (void)memcpy(&word, &t818_report_data[i * 8U], sizeof(word));
+    if (word != t818_last_report[i])
+    {
+      t818_last_report[i] = word;
+      changed = 1U;
+    }
+  }
+  return changed;
+}
+
+/**
+  * @brief  USBH_HID_T818DecodeFixed
+  *         The function decodes the report with the fixed T818 layout.
+  * @retval None
+  */
+static void USBH_HID_T818DecodeFixed(void)
+{
+  t818_sample.wheel_rotation = __load_le16(&t818_report_data[T818_X_AXIS_OFFSET]);
+  t818_sample.brake = __clamp_axis(__load_le16(&t818_report_data[T818_Y_AXIS_OFFSET]), T818_BRAKE_MAX);
+  t818_sample.throttle = __clamp_axis(__load_le16(&t818_report_data[T818_RZ_AXIS_OFFSET]), T818_THROTTLE_MAX);
+  t818_sample.clutch = __clamp_axis(__load_le16(&t818_report_data[T818_SLIDER_AXIS_OFFSET]), T818_CLUTCH_MAX);
+  t818_sample.vx_axis = t818_report_data[T818_VX_AXIS_OFFSET];
+  t818_sample.vy_axis = t818_report_data[T818_VY_AXIS_OFFSET];
+  t818_sample.rx_axis = t818_report_data[T818_RX_AXIS_OFFSET];
+  t818_sample.ry_axis = t818_report_data[T818_RY_AXIS_OFFSET];
+  t818_sample.z_axis = t818_report_data[T818_Z_AXIS_OFFSET];
+
+  const uint32_t button_bits = __load_le32(&t818_report_data[T818_BUTTONS_OFFSET]);
+  for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+  	t818_sample.buttons[i] = (uint8_t)((button_bits >> button_bit_positions[i]) & 1U);
+  }
+
+  t818_sample.pad_arrow = (uint8_t)(t818_report_data[T818_PAD_ARROW_OFFSET] & T818_PAD_ARROW_MAX);
+}
+
 /************************ END OF FILE****/
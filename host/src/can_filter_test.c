@@ -0,0 +1,127 @@
+/**
+ * @file can_filter_test.c
+ * @brief Checks the acceptance filters programmed by the CAN Manager.
+ *
+ * Initializes a CAN Manager on the simulated bus, then checks that the 16-bit
+ * ID list entries are exactly the RX identifiers of CAN_SIGNALS_MESSAGES, that
+ * every listed frame reaches can_manager_rx_pop() and that frames with any
+ * other identifier are rejected by the filters. Exits with EXIT_FAILURE if any
+ * check fails.
+ *
+ * Usage: can_filter_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "can_manager.h"
+#include "host_can.h"
+
+/** @brief Expands one message line into its identifier if it is received */
+#define __RX_ID(name, id, dlc, type, direction) (((direction) == CAN_SIGNALS_RX) ? (uint32_t) (id) : UINT32_MAX),
+
+/** @brief Identifiers of the frames expected to be received, UINT32_MAX for the transmitted ones */
+static const uint32_t message_ids[] = { CAN_SIGNALS_MESSAGES(__RX_ID) };
+
+/** @brief Identifiers expected to be rejected: the transmitted ones, the neighbours and the extremes */
+static const uint32_t rejected_ids[] = {
+	0x000U, 0x7FFU, CAN_SIGNALS_AUTO_CONTROL_ID,
+	CAN_SIGNALS_AUTO_DATA_FEEDBACK_ID - 1U, CAN_SIGNALS_AUTO_DATA_FEEDBACK_ID + 1U,
+	CAN_SIGNALS_AUTO_DATA_FEEDBACK_ID | 0x400U
+};
+
+static const can_manager_config_t config = {
+	.hcan = &hcan1,
+	.tx_messages = NULL,
+	.tx_message_count = 0U,
+	.auto_data_feedback_rx_fifo = CAN_RX_FIFO0,
+	.auto_data_feedback_rx_interrupt = CAN_IT_RX_FIFO0_MSG_PENDING,
+	.rx_filter_bank = 0U,
+	.bitrate = 500000U
+};
+
+static can_manager_t can_manager;
+static uint32_t failure_cnt = 0U;
+
+static void __check(int condition, const char *what) {
+	if (condition == 0) {
+		(void) fprintf(stderr, "FAIL: %s\n", what);
+		failure_cnt++;
+	}
+}
+
+static bool8u __is_rx_id(uint32_t std_id) {
+	bool8u found = CD_FALSE;
+
+	for (uint32_t i = 0U; i < (sizeof(message_ids) / sizeof(message_ids[0])); i++) {
+		if (message_ids[i] == std_id) {
+			found = CD_TRUE;
+		}
+	}
+	return found;
+}
+
+/**
+ * @brief Checks that the filter entries list the RX identifiers and nothing else.
+ */
+static void __check_filter_entries(void) {
+	const uint16_t *ids;
+	const uint32_t id_cnt = host_can_get_filter_ids(&ids);
+	uint32_t rx_id_cnt = 0U;
+
+	for (uint32_t i = 0U; i < (sizeof(message_ids) / sizeof(message_ids[0])); i++) {
+		if (message_ids[i] != UINT32_MAX) {
+			bool8u programmed = CD_FALSE;
+			for (uint32_t j = 0U; j < id_cnt; j++) {
+				if (ids[j] == (uint16_t) (message_ids[i] << 5U)) {
+					programmed = CD_TRUE;
+				}
+			}
+			__check(programmed == CD_TRUE, "every RX identifier has a filter entry");
+			rx_id_cnt++;
+		}
+	}
+
+	__check(id_cnt == (((rx_id_cnt + 3U) / 4U) * 4U), "one filter bank per four RX identifiers");
+	for (uint32_t j = 0U; j < id_cnt; j++) {
+		/* RTR, IDE and EXID[17:15] cleared: standard data frames only */
+		__check((ids[j] & 0x1FU) == 0U, "filter entries match standard data frames");
+		__check(__is_rx_id((uint32_t) ids[j] >> 5U) == CD_TRUE, "filter entries are RX identifiers");
+	}
+}
+
+/**
+ * @brief Checks that the listed frames are received and the others rejected.
+ */
+static void __check_reception(void) {
+	static const uint8_t data[8] = { 1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U };
+	can_manager_rx_frame_t frame;
+
+	for (uint32_t i = 0U; i < (sizeof(message_ids) / sizeof(message_ids[0])); i++) {
+		if (message_ids[i] != UINT32_MAX) {
+			host_can_receive(message_ids[i], data, sizeof(data));
+			__check(can_manager_rx_pop(&can_manager, &frame) == CAN_MANAGER_OK, "a listed frame is received");
+			__check(frame.header.StdId == message_ids[i], "the received frame has the listed identifier");
+		}
+	}
+
+	const uint32_t filtered_cnt = host_can_get_stats()->rx_filtered_cnt;
+	for (uint32_t i = 0U; i < (sizeof(rejected_ids) / sizeof(rejected_ids[0])); i++) {
+		host_can_receive(rejected_ids[i], data, sizeof(data));
+	}
+	__check((host_can_get_stats()->rx_filtered_cnt - filtered_cnt) == (sizeof(rejected_ids) / sizeof(rejected_ids[0])),
+			"every unlisted frame is rejected by the filters");
+	__check(can_manager_rx_pop(&can_manager, &frame) == CAN_MANAGER_RX_EMPTY, "no unlisted frame is received");
+}
+
+int main(void) {
+	if (can_manager_init(&can_manager, &config) != CAN_MANAGER_OK) {
+		(void) fprintf(stderr, "FAIL: can_manager_init\n");
+		failure_cnt++;
+	} else {
+		__check_filter_entries();
+		__check_reception();
+	}
+
+	(void) printf("can filter          %u failures\n", failure_cnt);
+	return (failure_cnt == 0U) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
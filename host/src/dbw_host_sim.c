@@ -0,0 +1,371 @@
+/**
+ * @file dbw_host_sim.c
+ * @brief Runs the DBW pipeline against the simulated wheel and chassis.
+ *
+ * Every virtual millisecond plays one USB frame and one millisecond of CAN
+ * bus, then the kernel steps due at that tick, with the periods of the target
+ * tasks. The chassis sends its Auto Data Feedback every 10 ms and the wheel is
+ * turned back and forth. A quarter into the run the USB host refuses a few
+ * force feedback submissions in a row. Three eighths into the run the chassis
+ * goes silent for SIM_FEEDBACK_GAP_MS. Halfway through the run the bus loses its
+ * acknowledgements, then is held by another node, for SIM_BUS_FAULT_MS each.
+ * Five eighths into the run one force feedback transfer stalls and is lost,
+ * which makes the effect play again. Three quarters into the run the wheel is unplugged and plugged back in. After
+ * each attach the USB host refuses the first submissions for a while, so that
+ * the force feedback configuration is still queued when the first effects are.
+ * The virtual clock runs as fast as the host allows.
+ *
+ * At the end of the run the statistics are printed and checked against what
+ * each of these events must produce; the exit status is EXIT_FAILURE if any
+ * check fails. The checks assume a run of at least SIM_MIN_RUN_MS.
+ *
+ * Usage: dbw_host_sim [virtual_ms]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "dbw_kernel.h"
+#include "host_can.h"
+#include "host_usbh.h"
+#include "virtual_clock.h"
+
+/** @brief Period of the simulated Auto Data Feedback frame */
+#define SIM_FEEDBACK_PERIOD_MS             (10U)
+/** @brief Tick at which the wheel is attached */
+#define SIM_ATTACH_TICK_MS                 (100U)
+/** @brief Time the wheel stays unplugged */
+#define SIM_UNPLUG_MS                      (500U)
+/** @brief Number of times the wheel is attached */
+#define SIM_ATTACH_CNT                     (2U)
+/** @brief Number of USB submissions refused in a row after each attach */
+#define SIM_ATTACH_SEND_FAILURES           (20U)
+/** @brief Number of USB submissions refused in a row */
+#define SIM_USB_SEND_FAILURES              (5U)
+/** @brief Length of each simulated bus fault */
+#define SIM_BUS_FAULT_MS                   (500U)
+/** @brief Time the chassis stays silent */
+#define SIM_FEEDBACK_GAP_MS                (1000U)
+/** @brief Time after the end of a fault within which its effects may still be seen */
+#define SIM_RECOVERY_MS                    (100U)
+/** @brief Force feedback packets of t818_ff_manager_init(): eight configuration packets and the gain */
+#define SIM_FF_CONFIG_PACKET_CNT           (9U)
+/** @brief Default length of the run */
+#define SIM_DEFAULT_RUN_MS                 (600000U)
+/** @brief Shortest run keeping the events apart */
+#define SIM_MIN_RUN_MS                     (16U * (SIM_FEEDBACK_GAP_MS + (2U * SIM_BUS_FAULT_MS)))
+
+/**
+ * @brief Counters of the run.
+ */
+typedef struct {
+	uint32_t update_step_cnt;
+	uint32_t update_error_cnt;
+	uint32_t urb_step_cnt;
+	uint32_t urb_error_cnt;
+	uint32_t can_step_cnt;
+	uint32_t can_error_cnt;
+	uint32_t fault_error_cnt;            /**< Step errors reported during the bus fault */
+	double update_seconds;               /**< Wall time spent in the update step */
+} sim_stats_t;
+
+/**
+ * @brief Force feedback traffic seen by the wheel after each attach.
+ */
+typedef struct {
+	uint8_t attach_cnt;
+	bool8u effect_seen;
+	uint32_t before_effect_cnt[SIM_ATTACH_CNT]; /**< Packets received before the first effect */
+	uint32_t play_cnt;                          /**< Effect plays received */
+} sim_ff_trace_t;
+
+/**
+ * @brief Auto Control frames sent around the silence of the chassis.
+ */
+typedef struct {
+	uint32_t gap_start;                  /**< Tick at which the chassis goes silent */
+	uint32_t safe_cnt;                   /**< Frames in the safe state once the feedback is stale */
+	uint32_t unsafe_cnt;                 /**< Frames not in the safe state once the feedback is stale */
+	uint32_t late_safe_cnt;              /**< Frames still in the safe state once the chassis is back */
+} sim_feedback_trace_t;
+
+static sim_ff_trace_t ff_trace;
+static sim_feedback_trace_t feedback_trace;
+static uint32_t fault_start;
+static uint32_t failure_cnt = 0U;
+
+static double __wall_seconds(void) {
+	struct timespec ts;
+	(void) timespec_get(&ts, TIME_UTC);
+	return (double) ts.tv_sec + ((double) ts.tv_nsec * 1e-9);
+}
+
+/**
+ * @brief Plays the chassis: sends the Auto Data Feedback with a steer following the command.
+ */
+static void __chassis_step(uint32_t now) {
+	const bool8u silent = ((now >= feedback_trace.gap_start) &&
+			(now < (feedback_trace.gap_start + SIM_FEEDBACK_GAP_MS))) ? CD_TRUE : CD_FALSE;
+
+	if (((now % SIM_FEEDBACK_PERIOD_MS) == 0U) && (silent == CD_FALSE)) {
+		const int16_t steer = (int16_t) ((int32_t) (now % 2000U) - 1000);
+		uint8_t data[8] = { 0U };
+		data[2] = (uint8_t) ((uint16_t) steer & 0xFFU);
+		data[3] = (uint8_t) ((uint16_t) steer >> 8U);
+		host_can_receive(CAN_SIGNALS_AUTO_DATA_FEEDBACK_ID, data, 8U);
+	}
+}
+
+/**
+ * @brief Plays the chassis receiving the Auto Control frames.
+ */
+static void __auto_control_observer(const CAN_TxHeaderTypeDef *header, const uint8_t *data) {
+	const uint32_t now = virtual_clock_get_tick();
+	const uint32_t stale = feedback_trace.gap_start + FEEDBACK_MAX_AGE_MS + SIM_RECOVERY_MS;
+	const uint32_t back = feedback_trace.gap_start + SIM_FEEDBACK_GAP_MS + SIM_RECOVERY_MS;
+
+	if (header->StdId == CAN_SIGNALS_AUTO_CONTROL_ID) {
+		/* speed at bits 0..15, braking at bits 16..31, EBP at bit 59, see can_signals.h */
+		const uint16_t speed = (uint16_t) ((uint16_t) data[0] | ((uint16_t) data[1] << 8U));
+		const uint16_t braking = (uint16_t) ((uint16_t) data[2] | ((uint16_t) data[3] << 8U));
+		const bool8u safe = ((speed == AUTO_CONTROL_MIN_SPEED) && (braking == AUTO_CONTROL_MAX_BRAKING) &&
+				((data[7] & 0x08U) != 0U)) ? CD_TRUE : CD_FALSE;
+
+		if ((now >= stale) && (now < (feedback_trace.gap_start + SIM_FEEDBACK_GAP_MS))) {
+			if (safe == CD_TRUE) {
+				(feedback_trace.safe_cnt)++;
+			} else {
+				(feedback_trace.unsafe_cnt)++;
+			}
+		} else if ((now >= back) && (now < (back + SIM_FEEDBACK_GAP_MS)) && (safe == CD_TRUE)) {
+			(feedback_trace.late_safe_cnt)++;
+		} else {
+			/* Outside the observed windows */
+		}
+	}
+}
+
+/**
+ * @brief Plays the wheel receiving force feedback packets.
+ */
+static void __ff_observer(const uint8_t *data, uint8_t length, uint8_t pipe_num) {
+	(void) length;
+	(void) pipe_num;
+	/* Constant force uploads and effect plays carry 0x6a and 0x89 at byte 3 */
+	if ((data[0] == 0x60U) && (data[1] == 0x00U) && ((data[3] == 0x6aU) || (data[3] == 0x89U))) {
+		ff_trace.effect_seen = CD_TRUE;
+		if (data[3] == 0x89U) {
+			(ff_trace.play_cnt)++;
+		}
+	} else if ((ff_trace.effect_seen == CD_FALSE) && (ff_trace.attach_cnt > 0U)) {
+		(ff_trace.before_effect_cnt[ff_trace.attach_cnt - 1U])++;
+	} else {
+		/* Not part of the configuration */
+	}
+}
+
+/**
+ * @brief Plugs and unplugs the wheel.
+ */
+static void __attach_step(uint32_t now, uint32_t run_ms) {
+	const uint32_t unplug = (run_ms / 4U) * 3U;
+
+	if ((now == SIM_ATTACH_TICK_MS) || (now == (unplug + SIM_UNPLUG_MS))) {
+		host_usbh_attach_t818();
+		host_usbh_set_send_failures(SIM_ATTACH_SEND_FAILURES);
+		ff_trace.effect_seen = CD_FALSE;
+		if (ff_trace.attach_cnt < SIM_ATTACH_CNT) {
+			(ff_trace.attach_cnt)++;
+		}
+	} else if (now == unplug) {
+		host_usbh_detach();
+	} else {
+		/* The wheel stays as it is */
+	}
+}
+
+/**
+ * @brief Plays the other nodes of the bus: no acknowledgement, then a busy bus, from the middle of the run.
+ */
+static void __bus_fault_step(uint32_t now) {
+	if (now == fault_start) {
+		host_can_set_bus_fault(HOST_CAN_BUS_NO_ACK);
+	} else if (now == (fault_start + SIM_BUS_FAULT_MS)) {
+		host_can_set_bus_fault(HOST_CAN_BUS_BUSY);
+	} else if (now == (fault_start + (2U * SIM_BUS_FAULT_MS))) {
+		host_can_set_bus_fault(HOST_CAN_BUS_OK);
+	} else {
+		/* Nothing to change at this tick */
+	}
+}
+
+/**
+ * @brief Counts a step error, apart if the bus fault may explain it.
+ */
+static void __count_error(uint32_t *error_cnt, sim_stats_t *sim, uint32_t now) {
+	if ((now >= fault_start) && (now < (fault_start + (2U * SIM_BUS_FAULT_MS) + SIM_RECOVERY_MS))) {
+		(sim->fault_error_cnt)++;
+	} else {
+		(*error_cnt)++;
+	}
+}
+
+static void __check(int condition, const char *what) {
+	if (condition == 0) {
+		(void) fprintf(stderr, "FAIL: %s\n", what);
+		failure_cnt++;
+	}
+}
+
+/**
+ * @brief Plays the driver: turns the wheel back and forth.
+ */
+static void __wheel_step(uint32_t now) {
+	uint8_t *report = host_usbh_t818_report();
+	const uint32_t phase = now % 4096U;
+	const uint16_t rotation = (uint16_t) (0x4000U + ((phase < 2048U) ? phase : (4096U - phase)) * 16U);
+	report[1] = (uint8_t) (rotation & 0xFFU);
+	report[2] = (uint8_t) (rotation >> 8U);
+}
+
+int main(int argc, char **argv) {
+	const uint32_t run_ms = (argc > 1) ? (uint32_t) strtoul(argv[1], NULL, 0) : SIM_DEFAULT_RUN_MS;
+	sim_stats_t sim = { 0U };
+	urb_sender_stats_t urb_stats;
+	can_manager_stats_t can_stats;
+	int exit_code = EXIT_SUCCESS;
+
+	host_usbh_set_urb_change_callback(dbw_kernel_urb_notify_from_isr);
+	host_usbh_set_out_observer(__ff_observer);
+	host_can_set_tx_observer(__auto_control_observer);
+	feedback_trace.gap_start = (run_ms / 8U) * 3U;
+	fault_start = run_ms / 2U;
+	if (run_ms < SIM_MIN_RUN_MS) {
+		(void) fprintf(stderr, "the run must last at least %u ms\n", SIM_MIN_RUN_MS);
+		exit_code = EXIT_FAILURE;
+	} else if (dbw_kernel_init() != DBW_OK) {
+		(void) fprintf(stderr, "dbw_kernel_init failed\n");
+		exit_code = EXIT_FAILURE;
+	} else {
+		const double start = __wall_seconds();
+
+		for (uint32_t t = 0U; t < run_ms; t++) {
+			virtual_clock_advance(1U);
+			const uint32_t now = virtual_clock_get_tick();
+
+			__attach_step(now, run_ms);
+			if (now == (run_ms / 4U)) {
+				host_usbh_set_send_failures(SIM_USB_SEND_FAILURES);
+			} else if (now == ((run_ms / 8U) * 5U)) {
+				host_usbh_set_out_fault(USBH_URB_STALL, 1U);
+			} else {
+				/* Nothing to change on the USB bus at this tick */
+			}
+			__wheel_step(now);
+			host_usbh_frame();
+			__bus_fault_step(now);
+			host_can_bus_step();
+			__chassis_step(now);
+
+#ifdef USE_CAN_TX_TASK
+			if ((now % CAN_TX_PERIOD_MS) == 0U) {
+				(sim.can_step_cnt)++;
+				if (dbw_kernel_can_tx_step() != DBW_OK) {
+					__count_error(&sim.can_error_cnt, &sim, now);
+				}
+			}
+#endif
+			if ((now % URB_TX_PERIOD_MS) == 0U) {
+				(sim.urb_step_cnt)++;
+				if (dbw_kernel_urb_tx_step() != DBW_OK) {
+					__count_error(&sim.urb_error_cnt, &sim, now);
+				}
+			}
+			if ((now % UPDATE_STATE_PERIOD_MS) == 0U) {
+				const double update_start = __wall_seconds();
+				(sim.update_step_cnt)++;
+				if (dbw_kernel_update_state_step() != DBW_OK) {
+					__count_error(&sim.update_error_cnt, &sim, now);
+				}
+				sim.update_seconds += __wall_seconds() - update_start;
+			}
+		}
+
+		const double elapsed = __wall_seconds() - start;
+		const dbw_kernel_t *kernel = dbw_kernel_get_instance();
+		const host_usbh_stats_t *usb = host_usbh_get_stats();
+		const host_can_stats_t *bus = host_can_get_stats();
+		(void) urb_sender_get_stats(&kernel->urb_sender, &urb_stats);
+		(void) can_manager_get_stats(&kernel->can_manager, &can_stats);
+
+		(void) printf("virtual time        %u ms in %.3f s (%.0fx real time)\n", run_ms, elapsed,
+				((double) run_ms / 1000.0) / elapsed);
+		(void) printf("update steps        %u, %u errors, %.0f ns/step\n", sim.update_step_cnt,
+				sim.update_error_cnt, (sim.update_seconds * 1e9) / (double) sim.update_step_cnt);
+		(void) printf("bus fault           %u step errors\n", sim.fault_error_cnt);
+		(void) printf("urb tx steps        %u, %u errors\n", sim.urb_step_cnt, sim.urb_error_cnt);
+		(void) printf("can tx steps        %u, %u errors\n", sim.can_step_cnt, sim.can_error_cnt);
+		(void) printf("wheel state         %u\n", (unsigned) kernel->drive_control.state);
+		(void) printf("usb                 %u reports in, %u out done, %u out faults, %u refused, %u bytes out\n",
+				usb->in_report_cnt, usb->out_done_cnt, usb->out_fault_cnt, usb->out_send_fail_cnt, usb->out_bytes);
+		(void) printf("urb sender          sent %u, retried %u, deferred %u, dropped %u, coalesced %u, expired %u, hwm %u\n",
+				urb_stats.sent_cnt, urb_stats.retried_cnt, urb_stats.deferred_cnt, urb_stats.dropped_cnt,
+				urb_stats.coalesced_cnt, urb_stats.expired_cnt, urb_stats.queue_hwm);
+		(void) printf("ff configuration    %u packets before the first effect, %u after the replug, %u plays\n",
+				ff_trace.before_effect_cnt[0], ff_trace.before_effect_cnt[1], ff_trace.play_cnt);
+		(void) printf("rotation manager    skipped %u, enqueue failures %u\n",
+				kernel->rotation_manager.ff_skipped_cnt, kernel->rotation_manager.ff_enqueue_fail_cnt);
+		(void) printf("can                 tx %u, rx %u, aborts %u, error callbacks %u, 0x183 sent %u, deadline misses %u\n",
+				bus->tx_cnt, can_stats.rx_cnt, kernel->can_manager.tx_abort_cnt, bus->error_callback_cnt,
+				kernel->can_manager.tx_slots[DBW_AUTO_CONTROL_TX_INDEX].tx_cnt,
+				kernel->can_manager.tx_slots[DBW_AUTO_CONTROL_TX_INDEX].deadline_miss_cnt);
+		(void) printf("feedback            stale %u, %u safe and %u unsafe frames while stale, %u safe frames once back\n",
+				kernel->auto_data_feedback_tracker.stale_cnt, feedback_trace.safe_cnt, feedback_trace.unsafe_cnt,
+				feedback_trace.late_safe_cnt);
+
+		/* Faults on a healthy run */
+		__check(sim.update_error_cnt == 0U, "no update step error outside the bus fault");
+		__check(sim.urb_error_cnt == 0U, "no URB step error outside the bus fault");
+		__check(sim.can_error_cnt == 0U, "no CAN step error outside the bus fault");
+		__check(kernel->rotation_manager.ff_enqueue_fail_cnt == 0U, "every force feedback command is accepted");
+		/* Refused submissions: deferred, neither retried nor lost */
+		__check(usb->out_send_fail_cnt == ((SIM_ATTACH_CNT * SIM_ATTACH_SEND_FAILURES) + SIM_USB_SEND_FAILURES),
+				"every injected submission failure is seen");
+		__check(urb_stats.deferred_cnt == usb->out_send_fail_cnt, "every refused submission is deferred");
+		__check(urb_stats.retried_cnt == 0U, "no refused submission counts as a retry");
+		/* Stall: the packet is lost once and the effect plays again */
+		__check(usb->out_fault_cnt == 1U, "the stall ends one transfer");
+		__check(urb_stats.dropped_cnt == 1U, "the stalled packet is the only one dropped");
+		__check(ff_trace.play_cnt == (SIM_ATTACH_CNT + 1U), "the effect plays once per attach and once after the stall");
+		/* Replug: the configuration comes first on each attach */
+		__check(ff_trace.attach_cnt == SIM_ATTACH_CNT, "the wheel is attached twice");
+		for (uint32_t i = 0U; i < SIM_ATTACH_CNT; i++) {
+			__check(ff_trace.before_effect_cnt[i] == SIM_FF_CONFIG_PACKET_CNT,
+					"the whole configuration reaches the wheel before the first effect");
+		}
+		__check(kernel->drive_control.state == MANUAL_DRIVING, "the wheel is driven again after the replug");
+		/* Bus fault: reported while it lasts, at most one missed release per period */
+		__check(sim.fault_error_cnt > 0U, "the bus fault is reported");
+		__check(bus->abort_cnt > 0U, "the frames stuck by the bus fault are aborted");
+		__check(kernel->can_manager.tx_slots[DBW_AUTO_CONTROL_TX_INDEX].deadline_miss_cnt <=
+				(((2U * SIM_BUS_FAULT_MS) + SIM_RECOVERY_MS) / UPDATE_STATE_PERIOD_MS),
+				"deadline misses are bounded by the bus fault");
+		__check(kernel->can_manager.tx_slots[DBW_AUTO_CONTROL_TX_INDEX].tx_cnt >=
+				(((run_ms - (2U * SIM_BUS_FAULT_MS) - SIM_RECOVERY_MS) / UPDATE_STATE_PERIOD_MS)),
+				"0x183 is sent every period outside the bus fault");
+		/* Stale feedback: the vehicle is stopped while the chassis is silent, then released */
+		__check(kernel->auto_data_feedback_tracker.stale_cnt > 0U, "the silence of the chassis makes the feedback stale");
+		__check(kernel->auto_data_feedback_tracker.stale_cnt <= (SIM_FEEDBACK_GAP_MS / UPDATE_STATE_PERIOD_MS),
+				"the feedback is stale only while the chassis is silent");
+		__check(feedback_trace.safe_cnt > 0U, "0x183 carries the safe state while the feedback is stale");
+		__check(feedback_trace.unsafe_cnt == 0U, "0x183 never leaves the safe state while the feedback is stale");
+		__check(feedback_trace.late_safe_cnt == 0U, "0x183 leaves the safe state once the chassis is back");
+
+		(void) printf("checks              %u failures\n", failure_cnt);
+		if (failure_cnt > 0U) {
+			exit_code = EXIT_FAILURE;
+		}
+	}
+
+	return exit_code;
+}
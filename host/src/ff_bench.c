@@ -0,0 +1,61 @@
+/**
+ * @file ff_bench.c
+ * @brief Measures the cost of building and submitting force feedback packets.
+ *
+ * Runs the two commands of the control path, a constant force upload and a
+ * constant force play, against a URB sender with the wheel unplugged, so that
+ * every packet is coalesced into the one already queued and only the cost of
+ * building and submitting it is measured.
+ *
+ * Usage: ff_bench [calls]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "dbw_kernel.h"
+
+/** @brief Default number of calls of each command */
+#define BENCH_DEFAULT_CALLS                (10000000U)
+
+static double __wall_seconds(void) {
+	struct timespec ts;
+	(void) timespec_get(&ts, TIME_UTC);
+	return (double) ts.tv_sec + ((double) ts.tv_nsec * 1e-9);
+}
+
+int main(int argc, char **argv) {
+	const uint32_t calls = (argc > 1) ? (uint32_t) strtoul(argv[1], NULL, 0) : BENCH_DEFAULT_CALLS;
+	static const urb_sender_config_t config = { .phost = &hUsbHostFS };
+	static urb_sender_t urb_sender;
+	uint32_t error_cnt = 0U;
+	int exit_code = EXIT_SUCCESS;
+
+	if (urb_sender_init(&urb_sender, &config) != URB_SENDER_OK) {
+		(void) fprintf(stderr, "urb_sender_init failed\n");
+		exit_code = EXIT_FAILURE;
+	} else {
+		double start = __wall_seconds();
+		for (uint32_t i = 0U; i < calls; i++) {
+			if (t818_ff_manager_upload_costant(&urb_sender, (int16_t) (i & 0x3FFFU)) != T818_FF_MANAGER_OK) {
+				error_cnt++;
+			}
+		}
+		const double upload_seconds = __wall_seconds() - start;
+
+		start = __wall_seconds();
+		for (uint32_t i = 0U; i < calls; i++) {
+			if (t818_ff_manager_play_costant(&urb_sender) != T818_FF_MANAGER_OK) {
+				error_cnt++;
+			}
+		}
+		const double play_seconds = __wall_seconds() - start;
+
+		(void) printf("upload costant      %.2f ns/call\n", (upload_seconds * 1e9) / (double) calls);
+		(void) printf("play costant        %.2f ns/call\n", (play_seconds * 1e9) / (double) calls);
+		(void) printf("errors              %u\n", error_cnt);
+		exit_code = (error_cnt == 0U) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	return exit_code;
+}
@@ -0,0 +1,109 @@
+/**
+ * @file ff_traffic_test.c
+ * @brief Counts the steady state force feedback traffic of the rotation manager.
+ *
+ * Runs the rotation manager with the URB sender against the simulated wheel,
+ * with the update and URB periods of the kernel, while the steer is held: the
+ * error seen by the regulator is a constant offset plus sensor noise. The
+ * completed OUT transfers are counted once with the deadband and the minimum
+ * resend interval of the kernel, once without either. Exits with EXIT_FAILURE
+ * if the filtered run does not at least halve the traffic.
+ *
+ * Usage: ff_traffic_test [virtual_ms]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "dbw_kernel.h"
+#include "host_usbh.h"
+#include "virtual_clock.h"
+
+/** @brief Default length of each run */
+#define TRAFFIC_DEFAULT_RUN_MS             (60000U)
+/** @brief Time given to the configuration and the first play, not counted */
+#define TRAFFIC_SETTLE_MS                  (1000U)
+/** @brief Steer error held by the regulator */
+#define TRAFFIC_ERROR_OFFSET               (40)
+/** @brief Peak sensor noise on the steer error */
+#define TRAFFIC_ERROR_NOISE                (4)
+
+static const urb_sender_config_t urb_config = { .phost = &hUsbHostFS };
+static urb_sender_t urb_sender;
+
+static void __urb_change(uint8_t pipe_num) {
+	urb_sender_notify_from_isr(&urb_sender, pipe_num);
+}
+
+/**
+ * @brief Runs the held steer with one configuration.
+ *
+ * @param config Configuration of the rotation manager.
+ * @param run_ms Length of the counted run.
+ * @param out_cnt Set to the OUT transfers completed during the counted run.
+ * @return CD_TRUE if every step succeeded.
+ */
+static bool8u __run(const rotation_manager_config_t *config, uint32_t run_ms, uint32_t *out_cnt) {
+	static rotation_manager_t rotation_manager;
+	static pid_t pid;
+	uint32_t seed = 1U;
+	uint32_t out_start = 0U;
+	bool8u ok = CD_FALSE;
+
+	host_usbh_attach_t818();
+	if ((urb_sender_init(&urb_sender, &urb_config) == URB_SENDER_OK) &&
+		(pid_init(&pid, PID_KP, PID_KI, PID_KD, T818_FF_MANAGER_MIN_CONSTANT_VALUE, T818_FF_MANAGER_MAX_CONSTANT_VALUE) == PID_OK) &&
+		(rotation_manager_init(&rotation_manager, config, &pid, &urb_sender) == ROTATION_MANAGER_OK) &&
+		(t818_ff_manager_init(&urb_sender) == T818_FF_MANAGER_OK)) {
+		ok = CD_TRUE;
+	}
+
+	for (uint32_t t = 0U; (t < (TRAFFIC_SETTLE_MS + run_ms)) && (ok == CD_TRUE); t++) {
+		virtual_clock_advance(1U);
+		const uint32_t now = virtual_clock_get_tick();
+
+		host_usbh_frame();
+		if (t == TRAFFIC_SETTLE_MS) {
+			out_start = host_usbh_get_stats()->out_done_cnt;
+		}
+		if (((now % URB_TX_PERIOD_MS) == 0U) && (urb_sender_dequeue_msg(&urb_sender) != URB_SENDER_OK)) {
+			ok = CD_FALSE;
+		}
+		if ((now % UPDATE_STATE_PERIOD_MS) == 0U) {
+			seed = (seed * 1103515245U) + 12345U;
+			const int32_t noise = (int32_t) ((seed >> 16U) % ((2U * TRAFFIC_ERROR_NOISE) + 1U)) - TRAFFIC_ERROR_NOISE;
+			if (rotation_manager_update(&rotation_manager, (float) (TRAFFIC_ERROR_OFFSET + noise), 0.0f) != ROTATION_MANAGER_OK) {
+				ok = CD_FALSE;
+			}
+		}
+	}
+
+	*out_cnt = host_usbh_get_stats()->out_done_cnt - out_start;
+	host_usbh_detach();
+	return ok;
+}
+
+int main(int argc, char **argv) {
+	const uint32_t run_ms = (argc > 1) ? (uint32_t) strtoul(argv[1], NULL, 0) : TRAFFIC_DEFAULT_RUN_MS;
+	static const rotation_manager_config_t unfiltered_config = { .ff_deadband = 0U, .ff_min_resend_ms = 0U };
+	static const rotation_manager_config_t kernel_config = { .ff_deadband = FF_DEADBAND, .ff_min_resend_ms = FF_MIN_RESEND_MS };
+	uint32_t unfiltered_cnt = 0U;
+	uint32_t filtered_cnt = 0U;
+	int exit_code = EXIT_FAILURE;
+
+	host_usbh_set_urb_change_callback(__urb_change);
+	if ((__run(&unfiltered_config, run_ms, &unfiltered_cnt) == CD_TRUE) &&
+		(__run(&kernel_config, run_ms, &filtered_cnt) == CD_TRUE)) {
+		(void) printf("ff traffic          %u ms held steer: %u URBs unfiltered, %u with deadband %u and resend %u ms (%.0f%%)\n",
+				run_ms, unfiltered_cnt, filtered_cnt, (unsigned) FF_DEADBAND, (unsigned) FF_MIN_RESEND_MS,
+				(100.0 * (double) filtered_cnt) / (double) unfiltered_cnt);
+		if ((unfiltered_cnt > 0U) && ((2U * filtered_cnt) <= unfiltered_cnt)) {
+			exit_code = EXIT_SUCCESS;
+		} else {
+			(void) fprintf(stderr, "FAIL: the steady state traffic is not halved\n");
+		}
+	} else {
+		(void) fprintf(stderr, "FAIL: a step of the rotation manager or the URB sender failed\n");
+	}
+
+	return exit_code;
+}
@@ -0,0 +1,128 @@
+/**
+ * @file freertos_stub.c
+ * @brief FreeRTOS queues and task notifications of the host build.
+ *
+ * Every task body runs on the harness thread, which is the only task: a
+ * notification is counted and taken back by the next ulTaskNotifyTake(), which
+ * never blocks.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "cmsis_os.h"
+#include "virtual_clock.h"
+
+struct tskTaskControlBlock {
+	uint32_t notify_cnt;
+};
+
+struct QueueDefinition {
+	uint8_t *storage;
+	UBaseType_t length;
+	UBaseType_t item_size;
+	UBaseType_t head;
+	UBaseType_t count;
+};
+
+static struct tskTaskControlBlock harness_task = { 0U };
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+	return &harness_task;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify) {
+	(xTaskToNotify->notify_cnt)++;
+	return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken) {
+	(xTaskToNotify->notify_cnt)++;
+	if (pxHigherPriorityTaskWoken != NULL) {
+		*pxHigherPriorityTaskWoken = pdTRUE;
+	}
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait) {
+	const uint32_t notify_cnt = harness_task.notify_cnt;
+	(void) xTicksToWait;
+	if (notify_cnt > 0U) {
+		harness_task.notify_cnt = (xClearCountOnExit == pdTRUE) ? 0U : (notify_cnt - 1U);
+	}
+	return notify_cnt;
+}
+
+TickType_t xTaskGetTickCount(void) {
+	return virtual_clock_get_tick();
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize) {
+	QueueHandle_t queue = calloc(1U, sizeof(*queue));
+	if (queue != NULL) {
+		queue->storage = calloc(uxQueueLength, uxItemSize);
+		queue->length = uxQueueLength;
+		queue->item_size = uxItemSize;
+		if (queue->storage == NULL) {
+			free(queue);
+			queue = NULL;
+		}
+	}
+	return queue;
+}
+
+void vQueueDelete(QueueHandle_t xQueue) {
+	if (xQueue != NULL) {
+		free(xQueue->storage);
+		free(xQueue);
+	}
+}
+
+BaseType_t xQueueSend(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait) {
+	BaseType_t status = errQUEUE_FULL;
+	(void) xTicksToWait;
+	if (xQueue->count < xQueue->length) {
+		const UBaseType_t tail = (xQueue->head + xQueue->count) % xQueue->length;
+		(void) memcpy(&xQueue->storage[tail * xQueue->item_size], pvItemToQueue, xQueue->item_size);
+		(xQueue->count)++;
+		status = pdPASS;
+	}
+	return status;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t xQueue, const void *pvItemToQueue, BaseType_t *pxHigherPriorityTaskWoken) {
+	if (pxHigherPriorityTaskWoken != NULL) {
+		*pxHigherPriorityTaskWoken = pdFALSE;
+	}
+	return xQueueSend(xQueue, pvItemToQueue, 0U);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait) {
+	BaseType_t status = errQUEUE_EMPTY;
+	(void) xTicksToWait;
+	if (xQueue->count > 0U) {
+		(void) memcpy(pvBuffer, &xQueue->storage[xQueue->head * xQueue->item_size], xQueue->item_size);
+		status = pdPASS;
+	}
+	return status;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait) {
+	const BaseType_t status = xQueuePeek(xQueue, pvBuffer, xTicksToWait);
+	if (status == pdPASS) {
+		xQueue->head = (xQueue->head + 1U) % xQueue->length;
+		(xQueue->count)--;
+	}
+	return status;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t xQueue) {
+	return xQueue->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t xQueue) {
+	return xQueue->length - xQueue->count;
+}
+
+osStatus osMessagePut(osMessageQId queue_id, uint32_t info, uint32_t millisec) {
+	return (xQueueSend(queue_id, &info, millisec) == pdPASS) ? osOK : osErrorOS;
+}
@@ -0,0 +1,286 @@
+/**
+ * @file hal_can_stub.c
+ * @brief Simulated bxCAN peripheral behind the HAL CAN API.
+ *
+ * The mailbox and error flag semantics follow HAL_CAN_IRQHandler(): a mailbox
+ * whose request completes without TXOK raises the abort callback only when
+ * neither ALST nor TERR is set, otherwise the flag is added to the error code
+ * reported through HAL_CAN_ErrorCallback().
+ */
+
+#include "can.h"
+#include "host_can.h"
+#include "virtual_clock.h"
+
+#define HOST_CAN_TX_MAILBOXES              (3U)
+#define HOST_CAN_RX_FIFO_DEPTH             (3U)
+#define HOST_CAN_MAX_FILTER_IDS            (28U * 4U)
+
+typedef struct {
+	uint8_t pending;
+	uint8_t abort;
+	CAN_TxHeaderTypeDef header;
+	uint8_t data[8];
+} host_can_mailbox_t;
+
+typedef struct {
+	CAN_RxHeaderTypeDef header;
+	uint8_t data[8];
+} host_can_rx_frame_t;
+
+typedef struct {
+	host_can_rx_frame_t frames[HOST_CAN_RX_FIFO_DEPTH];
+	uint32_t head;
+	uint32_t count;
+} host_can_rx_fifo_t;
+
+static CAN_TypeDef can1_registers;
+CAN_HandleTypeDef hcan1 = { .Instance = &can1_registers, .ErrorCode = HAL_CAN_ERROR_NONE };
+
+static host_can_mailbox_t tx_mailboxes[HOST_CAN_TX_MAILBOXES];
+static host_can_rx_fifo_t rx_fifos[2];
+static uint16_t filter_ids[HOST_CAN_MAX_FILTER_IDS];
+static uint8_t filter_fifos[HOST_CAN_MAX_FILTER_IDS];
+static uint32_t filter_id_cnt = 0U;
+static uint8_t started = 0U;
+static uint8_t bus_fault = HOST_CAN_BUS_OK;
+static host_can_stats_t stats;
+static host_can_tx_observer_t tx_observer = NULL;
+
+static const uint32_t alst_flags[HOST_CAN_TX_MAILBOXES] = {
+	HAL_CAN_ERROR_TX_ALST0, HAL_CAN_ERROR_TX_ALST1, HAL_CAN_ERROR_TX_ALST2
+};
+static const uint32_t terr_flags[HOST_CAN_TX_MAILBOXES] = {
+	HAL_CAN_ERROR_TX_TERR0, HAL_CAN_ERROR_TX_TERR1, HAL_CAN_ERROR_TX_TERR2
+};
+
+__weak void HAL_CAN_TxMailbox0CompleteCallback(CAN_HandleTypeDef *hcan) { UNUSED(hcan); }
+__weak void HAL_CAN_TxMailbox1CompleteCallback(CAN_HandleTypeDef *hcan) { UNUSED(hcan); }
+__weak void HAL_CAN_TxMailbox2CompleteCallback(CAN_HandleTypeDef *hcan) { UNUSED(hcan); }
+__weak void HAL_CAN_TxMailbox0AbortCallback(CAN_HandleTypeDef *hcan) { UNUSED(hcan); }
+__weak void HAL_CAN_TxMailbox1AbortCallback(CAN_HandleTypeDef *hcan) { UNUSED(hcan); }
+__weak void HAL_CAN_TxMailbox2AbortCallback(CAN_HandleTypeDef *hcan) { UNUSED(hcan); }
+__weak void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan) { UNUSED(hcan); }
+__weak void HAL_CAN_RxFifo1MsgPendingCallback(CAN_HandleTypeDef *hcan) { UNUSED(hcan); }
+__weak void HAL_CAN_ErrorCallback(CAN_HandleTypeDef *hcan) { UNUSED(hcan); }
+
+static void __tx_complete_callback(uint32_t index) {
+	if (index == 0U) {
+		HAL_CAN_TxMailbox0CompleteCallback(&hcan1);
+	} else if (index == 1U) {
+		HAL_CAN_TxMailbox1CompleteCallback(&hcan1);
+	} else {
+		HAL_CAN_TxMailbox2CompleteCallback(&hcan1);
+	}
+}
+
+static void __tx_abort_callback(uint32_t index) {
+	if (index == 0U) {
+		HAL_CAN_TxMailbox0AbortCallback(&hcan1);
+	} else if (index == 1U) {
+		HAL_CAN_TxMailbox1AbortCallback(&hcan1);
+	} else {
+		HAL_CAN_TxMailbox2AbortCallback(&hcan1);
+	}
+}
+
+HAL_StatusTypeDef HAL_CAN_ConfigFilter(CAN_HandleTypeDef *hcan, const CAN_FilterTypeDef *sFilterConfig) {
+	HAL_StatusTypeDef status = HAL_ERROR;
+	if ((hcan == &hcan1) && (sFilterConfig->FilterMode == CAN_FILTERMODE_IDLIST) &&
+		(sFilterConfig->FilterScale == CAN_FILTERSCALE_16BIT) &&
+		((filter_id_cnt + 4U) <= HOST_CAN_MAX_FILTER_IDS)) {
+		const uint32_t words[4] = { sFilterConfig->FilterIdHigh, sFilterConfig->FilterIdLow,
+				sFilterConfig->FilterMaskIdHigh, sFilterConfig->FilterMaskIdLow };
+		for (uint32_t i = 0U; i < 4U; i++) {
+			filter_ids[filter_id_cnt] = (uint16_t) words[i];
+			filter_fifos[filter_id_cnt] = (uint8_t) sFilterConfig->FilterFIFOAssignment;
+			filter_id_cnt++;
+		}
+		status = HAL_OK;
+	}
+	return status;
+}
+
+HAL_StatusTypeDef HAL_CAN_Start(CAN_HandleTypeDef *hcan) {
+	started = (hcan == &hcan1) ? 1U : 0U;
+	return (started != 0U) ? HAL_OK : HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_CAN_ActivateNotification(CAN_HandleTypeDef *hcan, uint32_t ActiveITs) {
+	hcan->Instance->IER |= ActiveITs;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_CAN_AddTxMessage(CAN_HandleTypeDef *hcan, const CAN_TxHeaderTypeDef *pHeader,
+		const uint8_t aData[], uint32_t *pTxMailbox) {
+	HAL_StatusTypeDef status = HAL_ERROR;
+	for (uint32_t i = 0U; (i < HOST_CAN_TX_MAILBOXES) && (status != HAL_OK); i++) {
+		if ((started != 0U) && (hcan == &hcan1) && (tx_mailboxes[i].pending == 0U)) {
+			tx_mailboxes[i].pending = 1U;
+			tx_mailboxes[i].abort = 0U;
+			tx_mailboxes[i].header = *pHeader;
+			(void) memcpy(tx_mailboxes[i].data, aData, sizeof(tx_mailboxes[i].data));
+			*pTxMailbox = 1UL << i;
+			status = HAL_OK;
+		}
+	}
+	return status;
+}
+
+HAL_StatusTypeDef HAL_CAN_AbortTxRequest(CAN_HandleTypeDef *hcan, uint32_t TxMailboxes) {
+	for (uint32_t i = 0U; i < HOST_CAN_TX_MAILBOXES; i++) {
+		if (((TxMailboxes & (1UL << i)) != 0U) && (tx_mailboxes[i].pending != 0U)) {
+			tx_mailboxes[i].abort = 1U;
+		}
+	}
+	return (hcan == &hcan1) ? HAL_OK : HAL_ERROR;
+}
+
+uint32_t HAL_CAN_GetTxMailboxesFreeLevel(const CAN_HandleTypeDef *hcan) {
+	uint32_t free_level = 0U;
+	for (uint32_t i = 0U; (i < HOST_CAN_TX_MAILBOXES) && (hcan == &hcan1); i++) {
+		if (tx_mailboxes[i].pending == 0U) {
+			free_level++;
+		}
+	}
+	return free_level;
+}
+
+uint32_t HAL_CAN_IsTxMessagePending(const CAN_HandleTypeDef *hcan, uint32_t TxMailboxes) {
+	uint32_t pending = 0U;
+	for (uint32_t i = 0U; (i < HOST_CAN_TX_MAILBOXES) && (hcan == &hcan1); i++) {
+		if (((TxMailboxes & (1UL << i)) != 0U) && (tx_mailboxes[i].pending != 0U)) {
+			pending = 1U;
+		}
+	}
+	return pending;
+}
+
+HAL_StatusTypeDef HAL_CAN_GetRxMessage(CAN_HandleTypeDef *hcan, uint32_t RxFifo,
+		CAN_RxHeaderTypeDef *pHeader, uint8_t aData[]) {
+	HAL_StatusTypeDef status = HAL_ERROR;
+	if ((hcan == &hcan1) && (RxFifo <= CAN_RX_FIFO1) && (rx_fifos[RxFifo].count > 0U)) {
+		host_can_rx_fifo_t *fifo = &rx_fifos[RxFifo];
+		*pHeader = fifo->frames[fifo->head].header;
+		(void) memcpy(aData, fifo->frames[fifo->head].data, sizeof(fifo->frames[fifo->head].data));
+		fifo->head = (fifo->head + 1U) % HOST_CAN_RX_FIFO_DEPTH;
+		(fifo->count)--;
+		status = HAL_OK;
+	}
+	return status;
+}
+
+uint32_t HAL_CAN_GetRxFifoFillLevel(const CAN_HandleTypeDef *hcan, uint32_t RxFifo) {
+	return ((hcan == &hcan1) && (RxFifo <= CAN_RX_FIFO1)) ? rx_fifos[RxFifo].count : 0U;
+}
+
+uint32_t HAL_CAN_GetError(const CAN_HandleTypeDef *hcan) {
+	return hcan->ErrorCode;
+}
+
+HAL_StatusTypeDef HAL_CAN_ResetError(CAN_HandleTypeDef *hcan) {
+	hcan->ErrorCode = HAL_CAN_ERROR_NONE;
+	return HAL_OK;
+}
+
+void host_can_bus_step(void) {
+	uint32_t error_code = HAL_CAN_ERROR_NONE;
+
+	/* A request ended by an abort raises the abort callback only without error flags */
+	for (uint32_t i = 0U; i < HOST_CAN_TX_MAILBOXES; i++) {
+		if ((tx_mailboxes[i].pending != 0U) && (tx_mailboxes[i].abort != 0U)) {
+			tx_mailboxes[i].pending = 0U;
+			tx_mailboxes[i].abort = 0U;
+			(stats.abort_cnt)++;
+			if (bus_fault == HOST_CAN_BUS_BUSY) {
+				error_code |= alst_flags[i];
+			} else if (bus_fault == HOST_CAN_BUS_NO_ACK) {
+				error_code |= terr_flags[i];
+			} else {
+				__tx_abort_callback(i);
+			}
+		}
+	}
+
+	for (uint32_t n = 0U; (n < HOST_CAN_FRAMES_PER_MS) && (bus_fault == HOST_CAN_BUS_OK); n++) {
+		uint32_t next = HOST_CAN_TX_MAILBOXES;
+		for (uint32_t i = 0U; i < HOST_CAN_TX_MAILBOXES; i++) {
+			if ((tx_mailboxes[i].pending != 0U) &&
+				((next == HOST_CAN_TX_MAILBOXES) || (tx_mailboxes[i].header.StdId < tx_mailboxes[next].header.StdId))) {
+				next = i;
+			}
+		}
+		if (next < HOST_CAN_TX_MAILBOXES) {
+			tx_mailboxes[next].pending = 0U;
+			tx_mailboxes[next].abort = 0U;
+			(stats.tx_cnt)++;
+			if (tx_observer != NULL) {
+				tx_observer(&tx_mailboxes[next].header, tx_mailboxes[next].data);
+			}
+			__tx_complete_callback(next);
+		}
+	}
+
+	if (error_code != HAL_CAN_ERROR_NONE) {
+		hcan1.ErrorCode |= error_code;
+		(stats.error_callback_cnt)++;
+		HAL_CAN_ErrorCallback(&hcan1);
+	}
+}
+
+void host_can_receive(uint32_t std_id, const uint8_t *data, uint32_t dlc) {
+	uint8_t accepted = 0U;
+
+	for (uint32_t i = 0U; (i < filter_id_cnt) && (started != 0U) && (accepted == 0U); i++) {
+		if (filter_ids[i] == (uint16_t) (std_id << 5U)) {
+			accepted = 1U;
+			const uint32_t fifo_index = filter_fifos[i];
+			host_can_rx_fifo_t *fifo = &rx_fifos[fifo_index];
+
+			if (fifo->count == HOST_CAN_RX_FIFO_DEPTH) {
+				(stats.rx_overrun_cnt)++;
+				hcan1.ErrorCode |= (fifo_index == CAN_RX_FIFO0) ? HAL_CAN_ERROR_RX_FOV0 : HAL_CAN_ERROR_RX_FOV1;
+				(stats.error_callback_cnt)++;
+				HAL_CAN_ErrorCallback(&hcan1);
+			} else {
+				host_can_rx_frame_t *frame = &fifo->frames[(fifo->head + fifo->count) % HOST_CAN_RX_FIFO_DEPTH];
+				(void) memset(frame, 0x00, sizeof(*frame));
+				frame->header.StdId = std_id;
+				frame->header.IDE = CAN_ID_STD;
+				frame->header.RTR = CAN_RTR_DATA;
+				frame->header.DLC = dlc;
+				frame->header.Timestamp = virtual_clock_get_tick() & 0xFFFFU;
+				frame->header.FilterMatchIndex = i;
+				(void) memcpy(frame->data, data, (dlc > 8U) ? 8U : dlc);
+				(fifo->count)++;
+				(stats.rx_cnt)++;
+				if (fifo_index == CAN_RX_FIFO0) {
+					HAL_CAN_RxFifo0MsgPendingCallback(&hcan1);
+				} else {
+					HAL_CAN_RxFifo1MsgPendingCallback(&hcan1);
+				}
+			}
+		}
+	}
+
+	if ((accepted == 0U) && (started != 0U)) {
+		(stats.rx_filtered_cnt)++;
+	}
+}
+
+void host_can_set_bus_fault(uint8_t fault) {
+	bus_fault = fault;
+}
+
+void host_can_set_tx_observer(host_can_tx_observer_t observer) {
+	tx_observer = observer;
+}
+
+uint32_t host_can_get_filter_ids(const uint16_t **ids) {
+	*ids = filter_ids;
+	return filter_id_cnt;
+}
+
+const host_can_stats_t *host_can_get_stats(void) {
+	return &stats;
+}
@@ -0,0 +1,11 @@
+/**
+ * @file hal_stub.c
+ * @brief HAL time base of the host build.
+ */
+
+#include "main.h"
+#include "virtual_clock.h"
+
+uint32_t HAL_GetTick(void) {
+	return virtual_clock_get_tick();
+}
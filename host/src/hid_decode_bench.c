@@ -0,0 +1,209 @@
+/**
+ * @file hid_decode_bench.c
+ * @brief Checks and measures the three decoders of a T818 report.
+ *
+ * The decoders are the fixed layout loads of USBH_HID_T818DecodeFixed(), the
+ * extraction plan that USBH_HID_T818Init() compiles from the report
+ * descriptor with HID_CompileReportDesc() and runs with HID_ExtractReport(),
+ * and the original one HID_ReadItem() call per field, rebuilt here from the
+ * item table the driver used before the plan. Src/usbh_hid_t818.c is included
+ * so that its static decoders can be called directly.
+ *
+ * The simulated T818 is attached so that the plan is compiled from its report
+ * descriptor. Random reports are then decoded by the three paths, which must
+ * give identical HID_T818_Info_TypeDef values, before each path is timed over
+ * the same reports. Exits with EXIT_FAILURE if the plan is not compiled or if
+ * any report decodes differently.
+ *
+ * Usage: hid_decode_bench [calls]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "host_usbh.h"
+#include "usbh_hid_t818.c"
+
+/** @brief Random reports checked for identical decoding */
+#define BENCH_CHECK_REPORT_CNT             (5000U)
+/** @brief Random reports replayed until the calls are done */
+#define BENCH_REPORT_CNT                   (256U)
+/** @brief Default number of calls of each decoder */
+#define BENCH_DEFAULT_CALLS                (10000000U)
+/** @brief Report ID of the simulated T818 */
+#define BENCH_REPORT_ID                    (1U)
+
+/** @brief Number of HID_ReadItem() fields: the axes, the arrow pad and the buttons */
+#define BENCH_ITEM_CNT                     (10U + BUTTON_COUNT)
+
+/**
+ * @brief One field of the original decoder.
+ */
+typedef struct {
+	HID_Report_ItemTypedef item;
+	uint8_t dest_offset;                 /**< Byte offset of the field in HID_T818_Info_TypeDef */
+	uint8_t dest_size;                   /**< Size of the field, 1 or 2 bytes */
+} bench_item_t;
+
+static bench_item_t items[BENCH_ITEM_CNT];
+static uint8_t reports[BENCH_REPORT_CNT][T818_REPORT_SIZE];
+
+static double __wall_seconds(void) {
+	struct timespec ts;
+	(void) timespec_get(&ts, TIME_UTC);
+	return (double) ts.tv_sec + ((double) ts.tv_nsec * 1e-9);
+}
+
+static void __add_item(uint8_t *cnt, uint32_t offset, uint8_t size, uint8_t shift, uint32_t max,
+		uint8_t dest_offset, uint8_t dest_size) {
+	bench_item_t *entry = &items[*cnt];
+	entry->item.data = &t818_report_data[offset];
+	entry->item.size = size;
+	entry->item.shift = shift;
+	entry->item.count = 0U;
+	entry->item.sign = 0U;
+	entry->item.logical_min = 0U;
+	entry->item.logical_max = max;
+	entry->item.physical_min = 0U;
+	entry->item.physical_max = max;
+	entry->item.resolution = 1U;
+	entry->dest_offset = dest_offset;
+	entry->dest_size = dest_size;
+	(*cnt)++;
+}
+
+/**
+ * @brief Rebuilds the item table of the original decoder, same offsets as the fixed layout.
+ */
+static void __build_items(void) {
+	uint8_t cnt = 0U;
+
+	__add_item(&cnt, T818_X_AXIS_OFFSET, 16U, 0U, T818_WHEEL_ROTATION_MAX, offsetof(HID_T818_Info_TypeDef, wheel_rotation), 2U);
+	__add_item(&cnt, T818_Y_AXIS_OFFSET, 16U, 0U, T818_BRAKE_MAX, offsetof(HID_T818_Info_TypeDef, brake), 2U);
+	__add_item(&cnt, T818_RZ_AXIS_OFFSET, 16U, 0U, T818_THROTTLE_MAX, offsetof(HID_T818_Info_TypeDef, throttle), 2U);
+	__add_item(&cnt, T818_SLIDER_AXIS_OFFSET, 16U, 0U, T818_CLUTCH_MAX, offsetof(HID_T818_Info_TypeDef, clutch), 2U);
+	__add_item(&cnt, T818_VX_AXIS_OFFSET, 8U, 0U, T818_VX_AXIS_MAX, offsetof(HID_T818_Info_TypeDef, vx_axis), 1U);
+	__add_item(&cnt, T818_VY_AXIS_OFFSET, 8U, 0U, T818_VY_AXIS_MAX, offsetof(HID_T818_Info_TypeDef, vy_axis), 1U);
+	__add_item(&cnt, T818_RX_AXIS_OFFSET, 8U, 0U, T818_RX_AXIS_MAX, offsetof(HID_T818_Info_TypeDef, rx_axis), 1U);
+	__add_item(&cnt, T818_RY_AXIS_OFFSET, 8U, 0U, T818_RY_AXIS_MAX, offsetof(HID_T818_Info_TypeDef, ry_axis), 1U);
+	__add_item(&cnt, T818_Z_AXIS_OFFSET, 8U, 0U, T818_Z_AXIS_MAX, offsetof(HID_T818_Info_TypeDef, z_axis), 1U);
+	__add_item(&cnt, T818_PAD_ARROW_OFFSET, 4U, 0U, T818_PAD_ARROW_MAX, offsetof(HID_T818_Info_TypeDef, pad_arrow), 1U);
+	for (uint8_t i = 0U; i < BUTTON_COUNT; i++) {
+		__add_item(&cnt, T818_BUTTONS_OFFSET + (button_bit_positions[i] / 8U), 1U, (uint8_t) (button_bit_positions[i] % 8U), 1U,
+				(uint8_t) (offsetof(HID_T818_Info_TypeDef, buttons) + i), 1U);
+	}
+}
+
+/**
+ * @brief Decodes t818_report_data with one HID_ReadItem() call per field.
+ */
+static void __decode_items(HID_T818_Info_TypeDef *info) {
+	uint8_t *dest = (uint8_t *) info;
+
+	for (uint8_t i = 0U; i < BENCH_ITEM_CNT; i++) {
+		const uint32_t value = HID_ReadItem(&items[i].item, 0U);
+		if (items[i].dest_size == 2U) {
+			const uint16_t value16 = (uint16_t) value;
+			(void) memcpy(&dest[items[i].dest_offset], &value16, sizeof(value16));
+		} else {
+			dest[items[i].dest_offset] = (uint8_t) value;
+		}
+	}
+}
+
+static void __decode_fixed(HID_T818_Info_TypeDef *info) {
+	USBH_HID_T818DecodeFixed();
+	*info = t818_sample;
+}
+
+static void __decode_plan(HID_T818_Info_TypeDef *info) {
+	(void) HID_ExtractReport(&t818_plan, t818_report_data, (uint8_t *) info);
+}
+
+static void __random_report(uint8_t *report, uint32_t *seed) {
+	for (uint32_t i = 0U; i < T818_REPORT_SIZE; i++) {
+		*seed = (*seed * 1103515245U) + 12345U;
+		report[i] = (uint8_t) (*seed >> 16U);
+	}
+	report[0] = BENCH_REPORT_ID;
+}
+
+/**
+ * @brief Decodes random reports with the three paths and counts the differences.
+ */
+static uint32_t __check_decoders(void) {
+	HID_T818_Info_TypeDef fixed;
+	HID_T818_Info_TypeDef plan;
+	HID_T818_Info_TypeDef item;
+	uint32_t seed = 1U;
+	uint32_t mismatch_cnt = 0U;
+
+	for (uint32_t n = 0U; n < BENCH_CHECK_REPORT_CNT; n++) {
+		__random_report(t818_report_data, &seed);
+		(void) memset(&t818_sample, 0, sizeof(t818_sample));
+		(void) memset(&plan, 0, sizeof(plan));
+		(void) memset(&item, 0, sizeof(item));
+		__decode_fixed(&fixed);
+		__decode_plan(&plan);
+		__decode_items(&item);
+		if ((memcmp(&fixed, &plan, sizeof(fixed)) != 0) || (memcmp(&fixed, &item, sizeof(fixed)) != 0)) {
+			if (mismatch_cnt == 0U) {
+				(void) fprintf(stderr, "FAIL: report %u decodes to wheel %u/%u/%u, pad %u/%u/%u\n", n,
+						fixed.wheel_rotation, plan.wheel_rotation, item.wheel_rotation,
+						fixed.pad_arrow, plan.pad_arrow, item.pad_arrow);
+			}
+			mismatch_cnt++;
+		}
+	}
+	return mismatch_cnt;
+}
+
+static double __time_decoder(void (*decode)(HID_T818_Info_TypeDef *info), uint32_t calls, uint32_t *checksum) {
+	HID_T818_Info_TypeDef info = { 0 };
+	const double start = __wall_seconds();
+
+	for (uint32_t i = 0U; i < calls; i++) {
+		(void) memcpy(t818_report_data, reports[i % BENCH_REPORT_CNT], T818_REPORT_SIZE);
+		decode(&info);
+		*checksum += info.wheel_rotation + info.buttons[BUTTON_ENG];
+	}
+	return ((__wall_seconds() - start) * 1e9) / (double) calls;
+}
+
+int main(int argc, char **argv) {
+	const uint32_t calls = (argc > 1) ? (uint32_t) strtoul(argv[1], NULL, 0) : BENCH_DEFAULT_CALLS;
+	uint32_t seed = 2U;
+	uint32_t checksum = 0U;
+	int exit_code = EXIT_FAILURE;
+
+	/* The HID class runs USBH_HID_T818Init() from its process, within the first frames */
+	host_usbh_attach_t818();
+	for (uint32_t i = 0U; i < 10U; i++) {
+		host_usbh_frame();
+	}
+	__build_items();
+
+	if (t818_plan.count == 0U) {
+		(void) fprintf(stderr, "FAIL: the report descriptor of the simulated T818 is not compiled\n");
+	} else {
+		const uint32_t mismatch_cnt = __check_decoders();
+
+		(void) printf("decoders            %u plan steps, %u of %u random reports decoded differently\n",
+				t818_plan.count, mismatch_cnt, BENCH_CHECK_REPORT_CNT);
+		if (mismatch_cnt == 0U) {
+			exit_code = EXIT_SUCCESS;
+		}
+
+		for (uint32_t i = 0U; i < BENCH_REPORT_CNT; i++) {
+			__random_report(reports[i], &seed);
+		}
+		const double fixed_ns = __time_decoder(__decode_fixed, calls, &checksum);
+		const double plan_ns = __time_decoder(__decode_plan, calls, &checksum);
+		const double item_ns = __time_decoder(__decode_items, calls, &checksum);
+		(void) printf("fixed layout        %.2f ns/report\n", fixed_ns);
+		(void) printf("extraction plan     %.2f ns/report\n", plan_ns);
+		(void) printf("HID_ReadItem        %.2f ns/report (checksum %u)\n", item_ns, checksum);
+	}
+
+	return exit_code;
+}
@@ -0,0 +1,203 @@
+/**
+ * @file hid_parser_test.c
+ * @brief Checks HID_CompileReportDesc() against crafted and random descriptors.
+ *
+ * The crafted descriptors exercise the bounds of the compiler: a huge report
+ * count, more fields than plan steps, a field past byte 255, a report size of
+ * 0, truncated items and an unbalanced global item stack. The random ones,
+ * sequences of the items the compiler interprets with random data around one
+ * valid X field, only have to compile, or fail with an empty plan, without any
+ * step reading past the report.
+ * Exits with EXIT_FAILURE if any check fails.
+ *
+ * Usage: hid_parser_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "usbh_hid_parser.h"
+
+/** @brief Random descriptors compiled */
+#define TEST_RANDOM_DESC_CNT               (20000U)
+/** @brief Largest random descriptor, in items */
+#define TEST_RANDOM_ITEM_CNT               (24U)
+/** @brief Report length given to the compiler, as for the T818 */
+#define TEST_REPORT_LENGTH                 (64U)
+
+/* Button 1 into byte 0, X into bytes 2 and 3 */
+static const HID_Usage_MapTypedef map[] = {
+	{ HID_EXTENDED_USAGE(0x09U, 0x01U), 0U, 1U, 1U },
+	{ HID_EXTENDED_USAGE(0x01U, 0x30U), 2U, 2U, 0xFFFFU }
+};
+
+/* One byte items drawn by the random descriptors: usage page, usage, usage
+ * minimum and maximum, logical minimum, report size, report count, report ID,
+ * input, push, pop, collection and end of collection */
+static const uint8_t item_prefixes[] = {
+	0x05, 0x09, 0x19, 0x29, 0x15, 0x75, 0x95, 0x85, 0x81, 0xA4, 0xB4, 0xA1, 0xC0
+};
+
+/* X as 16 bits, inserted among the random items so that most descriptors map a field */
+static const uint8_t x_field[] = { 0x05, 0x01, 0x09, 0x30, 0x75, 0x10, 0x95, 0x01, 0x81, 0x02 };
+
+static uint32_t failure_cnt = 0U;
+
+static void __check(int condition, const char *what) {
+	if (condition == 0) {
+		(void) fprintf(stderr, "FAIL: %s\n", what);
+		failure_cnt++;
+	}
+}
+
+static USBH_StatusTypeDef __compile(const uint8_t *desc, uint16_t length, uint16_t report_length,
+		HID_Extract_PlanTypedef *plan) {
+	return HID_CompileReportDesc(desc, length, map, (uint8_t) (sizeof(map) / sizeof(map[0])), report_length, plan);
+}
+
+static void __check_crafted(void) {
+	HID_Extract_PlanTypedef plan;
+
+	/* Button page, usages 1 to 0xFFFF, size 1, count 0xFFFFFFFF: stops at the end of the report */
+	static const uint8_t huge_count[] = {
+		0x05, 0x09, 0x19, 0x01, 0x2A, 0xFF, 0xFF, 0x75, 0x01, 0x97, 0xFF, 0xFF, 0xFF, 0xFF, 0x81, 0x02
+	};
+	__check((__compile(huge_count, sizeof(huge_count), TEST_REPORT_LENGTH, &plan) == USBH_OK) &&
+			(plan.count == 1U) && (plan.steps[0].byte_offset == 0U), "a huge report count stops at the report end");
+
+	/* 64 fields of button 1: more steps than HID_EXTRACT_MAX_STEPS */
+	static const uint8_t too_many_steps[] = { 0x05, 0x09, 0x09, 0x01, 0x75, 0x01, 0x95, 0x40, 0x81, 0x02 };
+	__check((__compile(too_many_steps, sizeof(too_many_steps), TEST_REPORT_LENGTH, &plan) != USBH_OK) &&
+			(plan.count == 0U), "more fields than plan steps fail with an empty plan");
+
+	/* 256 bytes of padding push X past byte 255, which a step cannot address */
+	static const uint8_t past_byte_255[] = {
+		0x75, 0x08, 0x96, 0x00, 0x01, 0x81, 0x01, 0x05, 0x01, 0x09, 0x30, 0x75, 0x10, 0x95, 0x01, 0x81, 0x02
+	};
+	__check((__compile(past_byte_255, sizeof(past_byte_255), 1024U, &plan) != USBH_OK) && (plan.count == 0U),
+			"a field past byte 255 fails with an empty plan");
+
+	/* One byte of padding, then X */
+	static const uint8_t x_at_byte_1[] = {
+		0x75, 0x08, 0x95, 0x01, 0x81, 0x01, 0x05, 0x01, 0x09, 0x30, 0x75, 0x10, 0x95, 0x01, 0x81, 0x02
+	};
+	__check((__compile(x_at_byte_1, sizeof(x_at_byte_1), TEST_REPORT_LENGTH, &plan) == USBH_OK) &&
+			(plan.count == 1U) && (plan.steps[0].byte_offset == 1U) && (plan.steps[0].shift == 0U) &&
+			(plan.steps[0].mask == 0xFFFFU), "X after one byte of padding is at byte 1");
+
+	/* Size 0 with a huge count takes no bits: X still starts at byte 0 */
+	static const uint8_t size_0[] = {
+		0x05, 0x09, 0x09, 0x01, 0x75, 0x00, 0x97, 0xFF, 0xFF, 0xFF, 0xFF, 0x81, 0x02,
+		0x05, 0x01, 0x09, 0x30, 0x75, 0x10, 0x95, 0x01, 0x81, 0x02
+	};
+	__check((__compile(size_0, sizeof(size_0), TEST_REPORT_LENGTH, &plan) == USBH_OK) &&
+			(plan.count == 1U) && (plan.steps[0].byte_offset == 0U), "a field of size 0 is skipped");
+
+	/* Report count announced on 4 bytes, only 2 present */
+	static const uint8_t truncated[] = { 0x05, 0x01, 0x09, 0x30, 0x75, 0x10, 0x97, 0x01, 0x00 };
+	__check(__compile(truncated, sizeof(truncated), TEST_REPORT_LENGTH, &plan) != USBH_OK,
+			"a truncated item fails");
+
+	/* Pop without Push, then one Push more than the stack holds */
+	static const uint8_t pop_empty[] = { 0xB4 };
+	__check(__compile(pop_empty, sizeof(pop_empty), TEST_REPORT_LENGTH, &plan) != USBH_OK,
+			"a Pop on an empty stack fails");
+	uint8_t push_overflow[HID_PARSER_STACK_DEPTH + 1U];
+	for (uint32_t i = 0U; i < sizeof(push_overflow); i++) {
+		push_overflow[i] = 0xA4U;
+	}
+	__check(__compile(push_overflow, sizeof(push_overflow), TEST_REPORT_LENGTH, &plan) != USBH_OK,
+			"a Push on a full stack fails");
+}
+
+/**
+ * @brief Compiles random descriptors: every step of a compiled plan must stay within the report.
+ */
+static void __check_random(void) {
+	static uint8_t desc[(2U * TEST_RANDOM_ITEM_CNT) + sizeof(x_field)];
+	HID_Extract_PlanTypedef plan;
+	uint32_t seed = 1U;
+	uint32_t compiled_cnt = 0U;
+	uint32_t step_cnt = 0U;
+	uint32_t out_of_report_cnt = 0U;
+
+	for (uint32_t n = 0U; n < TEST_RANDOM_DESC_CNT; n++) {
+		seed = (seed * 1103515245U) + 12345U;
+		const uint32_t item_cnt = (seed >> 16U) % (TEST_RANDOM_ITEM_CNT + 1U);
+		uint16_t length = 0U;
+		uint32_t push_depth = 0U;
+		seed = (seed * 1103515245U) + 12345U;
+		const uint32_t x_position = (seed >> 16U) % (item_cnt + 1U);
+		for (uint32_t i = 0U; i <= item_cnt; i++) {
+			if (i == x_position) {
+				(void) memcpy(&desc[length], x_field, sizeof(x_field));
+				length += (uint16_t) sizeof(x_field);
+			}
+			if (i == item_cnt) {
+				break;
+			}
+			seed = (seed * 1103515245U) + 12345U;
+			uint8_t prefix = item_prefixes[(seed >> 16U) % sizeof(item_prefixes)];
+			/* A Pop on an empty stack is checked by the crafted descriptors */
+			if (prefix == 0xA4U) {
+				push_depth++;
+			} else if (prefix == 0xB4U) {
+				if (push_depth == 0U) {
+					prefix = 0xA4U;
+					push_depth++;
+				} else {
+					push_depth--;
+				}
+			} else {
+				/* Not a stack item */
+			}
+			desc[length] = prefix;
+			length++;
+			/* Push, Pop and End Collection carry no data */
+			if ((prefix & 0x03U) != 0U) {
+				seed = (seed * 1103515245U) + 12345U;
+				/* Small data most of the time, so that usages and sizes hit the map */
+				uint8_t data = (uint8_t) (((seed >> 24U) < 192U) ? ((seed >> 16U) & 0x3FU) : (seed >> 16U));
+				if (prefix == 0x05U) {
+					data = (uint8_t) (((seed >> 16U) & 1U) ? 0x01U : 0x09U);
+				} else if ((prefix == 0x09U) && ((seed >> 24U) < 128U)) {
+					data = (uint8_t) (((seed >> 16U) & 1U) ? 0x30U : 0x01U);
+				} else if ((prefix == 0x75U) && ((seed >> 24U) < 192U)) {
+					data = (uint8_t) (1U + ((seed >> 16U) % 16U));
+				} else if ((prefix == 0x95U) && ((seed >> 24U) < 192U)) {
+					data = (uint8_t) (1U + ((seed >> 16U) % 8U));
+				} else if ((prefix == 0x81U) && ((seed >> 24U) < 192U)) {
+					/* Data, variable: a field the compiler maps */
+					data = 0x02U;
+				} else {
+					/* Any other data is kept */
+				}
+				desc[length] = data;
+				length++;
+			}
+		}
+		if (__compile(desc, length, TEST_REPORT_LENGTH, &plan) == USBH_OK) {
+			compiled_cnt++;
+			step_cnt += plan.count;
+			for (uint8_t i = 0U; i < plan.count; i++) {
+				/* A step loads 3 bytes from its byte offset */
+				if ((plan.steps[i].byte_offset + 3U) > TEST_REPORT_LENGTH) {
+					out_of_report_cnt++;
+				}
+			}
+		} else {
+			__check(plan.count == 0U, "a descriptor that fails to compile leaves an empty plan");
+		}
+	}
+	(void) printf("random descriptors  %u compiled of %u, %u plan steps\n", compiled_cnt, TEST_RANDOM_DESC_CNT, step_cnt);
+	__check(compiled_cnt > 0U, "some random descriptors compile");
+	__check(out_of_report_cnt == 0U, "no step of a compiled plan reads past the report");
+}
+
+int main(void) {
+	__check_crafted();
+	__check_random();
+
+	(void) printf("hid parser          %u failures\n", failure_cnt);
+	return (failure_cnt == 0U) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
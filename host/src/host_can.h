@@ -0,0 +1,84 @@
+/**
+ * @file host_can.h
+ * @brief Simulated CAN bus of the host build.
+ *
+ * hcan1 behaves like a bxCAN peripheral with three TX mailboxes and a
+ * three-frame RX FIFO per FIFO. The bus only moves when host_can_bus_step() is
+ * called, which raises the same HAL callbacks as HAL_CAN_IRQHandler().
+ */
+
+#ifndef HOST_CAN_H_
+#define HOST_CAN_H_
+
+#include "main.h"
+
+/** @brief The bus carries every pending frame */
+#define HOST_CAN_BUS_OK                    (0U)
+/** @brief Frames keep losing arbitration, aborts end with HAL_CAN_ERROR_TX_ALSTn */
+#define HOST_CAN_BUS_BUSY                  (1U)
+/** @brief Frames are never acknowledged, aborts end with HAL_CAN_ERROR_TX_TERRn */
+#define HOST_CAN_BUS_NO_ACK                (2U)
+
+/** @brief Frames carried per millisecond, about a 500 kbit/s bus */
+#define HOST_CAN_FRAMES_PER_MS             (4U)
+
+/**
+ * @brief Counters of the simulated bus.
+ */
+typedef struct {
+	uint32_t tx_cnt;                     /**< Frames transmitted */
+	uint32_t abort_cnt;                  /**< Frames aborted, with or without error flags */
+	uint32_t rx_cnt;                     /**< Frames stored in a RX FIFO */
+	uint32_t rx_filtered_cnt;            /**< Frames rejected by the acceptance filters */
+	uint32_t rx_overrun_cnt;             /**< Frames lost on a full RX FIFO */
+	uint32_t error_callback_cnt;         /**< Calls of HAL_CAN_ErrorCallback() */
+} host_can_stats_t;
+
+/**
+ * @brief Observer of the transmitted frames.
+ */
+typedef void (*host_can_tx_observer_t)(const CAN_TxHeaderTypeDef *header, const uint8_t *data);
+
+/**
+ * @brief Runs one millisecond of bus activity.
+ *
+ * Completes the requested aborts, then transmits up to HOST_CAN_FRAMES_PER_MS
+ * pending frames, lowest identifier first.
+ */
+void host_can_bus_step(void);
+
+/**
+ * @brief Puts a frame on the bus, to be received if the filters accept it.
+ *
+ * @param std_id Standard identifier.
+ * @param data Payload.
+ * @param dlc Number of payload bytes.
+ */
+void host_can_receive(uint32_t std_id, const uint8_t *data, uint32_t dlc);
+
+/**
+ * @brief Selects the bus condition seen by the pending frames.
+ *
+ * @param fault HOST_CAN_BUS_OK, HOST_CAN_BUS_BUSY or HOST_CAN_BUS_NO_ACK.
+ */
+void host_can_set_bus_fault(uint8_t fault);
+
+/**
+ * @brief Registers the observer of the transmitted frames, NULL for none.
+ */
+void host_can_set_tx_observer(host_can_tx_observer_t observer);
+
+/**
+ * @brief Returns the identifiers programmed in the acceptance filters.
+ *
+ * @param ids Set to the filter entries, in the 16-bit list layout (STDID << 5).
+ * @return Number of entries, four per configured filter bank.
+ */
+uint32_t host_can_get_filter_ids(const uint16_t **ids);
+
+/**
+ * @brief Returns the counters of the simulated bus.
+ */
+const host_can_stats_t *host_can_get_stats(void);
+
+#endif /* HOST_CAN_H_ */
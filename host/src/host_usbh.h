@@ -0,0 +1,94 @@
+/**
+ * @file host_usbh.h
+ * @brief Simulated USB host port with a T818 attached, for the host build.
+ *
+ * hUsbHostFS runs the real HID class of Src/usbh_hid.c. The enumeration is
+ * replaced by host_usbh_attach_t818(), and host_usbh_frame() plays the role of
+ * one 1 ms USB frame: it completes the URBs submitted during the previous
+ * frame, then runs the SOF and background processes of the active class, as
+ * the SOF interrupt and the USBH task do on the target.
+ */
+
+#ifndef HOST_USBH_H_
+#define HOST_USBH_H_
+
+#include "usbh_core.h"
+
+/**
+ * @brief Counters of the simulated port.
+ */
+typedef struct {
+	uint32_t out_submit_cnt;             /**< OUT transfers accepted by USBH_InterruptSendData() */
+	uint32_t out_done_cnt;               /**< OUT transfers completed with URB done */
+	uint32_t out_fault_cnt;              /**< OUT transfers ended by an injected fault */
+	uint32_t out_send_fail_cnt;          /**< USBH_InterruptSendData() calls failed on purpose */
+	uint32_t out_bytes;                  /**< Bytes of the OUT transfers completed with URB done */
+	uint32_t in_report_cnt;              /**< IN reports delivered to the HID class */
+} host_usbh_stats_t;
+
+/**
+ * @brief Observer of the OUT transfers received by the wheel.
+ */
+typedef void (*host_usbh_out_observer_t)(const uint8_t *data, uint8_t length, uint8_t pipe_num);
+
+/**
+ * @brief Observer of the URB state changes, like HAL_HCD_HC_NotifyURBChange_Callback.
+ */
+typedef void (*host_usbh_urb_change_t)(uint8_t pipe_num);
+
+/**
+ * @brief Attaches a T818 and brings the HID class up to the class state.
+ */
+void host_usbh_attach_t818(void);
+
+/**
+ * @brief Detaches the device, as the disconnection handling of the core does.
+ */
+void host_usbh_detach(void);
+
+/**
+ * @brief Runs one 1 ms USB frame.
+ */
+void host_usbh_frame(void);
+
+/**
+ * @brief Returns the report sent by the wheel on the next IN transfers.
+ *
+ * The report starts with report ID 1 and follows the layout of the report
+ * descriptor returned by the simulated wheel.
+ *
+ * @return Pointer to the T818_REPORT_SIZE bytes of the report.
+ */
+uint8_t *host_usbh_t818_report(void);
+
+/**
+ * @brief Makes the next OUT transfers end in a given URB state.
+ *
+ * @param urb_state State reported instead of USBH_URB_DONE.
+ * @param count Number of transfers affected.
+ */
+void host_usbh_set_out_fault(USBH_URBStateTypeDef urb_state, uint32_t count);
+
+/**
+ * @brief Makes the next USBH_InterruptSendData() calls fail.
+ *
+ * @param count Number of calls affected.
+ */
+void host_usbh_set_send_failures(uint32_t count);
+
+/**
+ * @brief Registers the observer of the OUT transfers, NULL for none.
+ */
+void host_usbh_set_out_observer(host_usbh_out_observer_t observer);
+
+/**
+ * @brief Registers the observer of the URB state changes, NULL for none.
+ */
+void host_usbh_set_urb_change_callback(host_usbh_urb_change_t callback);
+
+/**
+ * @brief Returns the counters of the simulated port.
+ */
+const host_usbh_stats_t *host_usbh_get_stats(void);
+
+#endif /* HOST_USBH_H_ */
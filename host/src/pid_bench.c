@@ -0,0 +1,126 @@
+/**
+ * @file pid_bench.c
+ * @brief Measures the cost and the accuracy of one PID regulator build.
+ *
+ * The same source is built once per numeric engine (double, float and
+ * Q15.16 fixed point, see CMakeLists.txt). It runs pid_calculate_output()
+ * over a steering error sequence with the gains and limits of the kernel,
+ * then prints the time per call and the largest deviation of the output from
+ * a double precision reference of the same clamping regulator fed with the
+ * same errors. The fixed point engine gets errors rounded to integers, as in
+ * rotation_manager_update().
+ *
+ * Usage: pid_bench_<engine> [calls]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "pid_regulator.h"
+
+/** @brief Length of the error sequence, replayed until the calls are done */
+#define BENCH_ERROR_CNT                    (4096U)
+/** @brief Default number of calls */
+#define BENCH_DEFAULT_CALLS                (20000000U)
+/** @brief Output limits of the kernel regulator */
+#define BENCH_UKMIN                        (-16385)
+#define BENCH_UKMAX                        (16381)
+
+#if defined(USE_FIXED_POINT_PID)
+#define BENCH_ENGINE                       "fixed Q15.16"
+#elif defined(USE_SINGLE_PRECISION)
+#define BENCH_ENGINE                       "float"
+#else
+#define BENCH_ENGINE                       "double"
+#endif
+
+/**
+ * @brief Double precision reference of the clamping regulator.
+ */
+typedef struct {
+	double kp;
+	double ki;
+	double kd;
+	double e_old;
+	double u_old;
+	double sk;
+} bench_reference_t;
+
+static pid_signal_t signals[BENCH_ERROR_CNT];
+
+static double __wall_seconds(void) {
+	struct timespec ts;
+	(void) timespec_get(&ts, TIME_UTC);
+	return (double) ts.tv_sec + ((double) ts.tv_nsec * 1e-9);
+}
+
+/**
+ * @brief Builds a steering error: a slow swing of the wheel plus sensor noise.
+ */
+static void __build_errors(void) {
+	uint32_t seed = 1U;
+
+	for (uint32_t i = 0U; i < BENCH_ERROR_CNT; i++) {
+		const uint32_t phase = i % 1024U;
+		const double swing = (phase < 512U) ? ((double) phase - 256.0) : (768.0 - (double) phase);
+		seed = (seed * 1103515245U) + 12345U;
+		const double error = (swing * 2.0) + ((double) ((seed >> 16U) & 0xFFU) / 64.0) - 2.0;
+#ifdef USE_FIXED_POINT_PID
+		signals[i] = (pid_signal_t) lround(error);
+#else
+		signals[i] = (pid_signal_t) error;
+#endif
+	}
+}
+
+static double __reference_output(bench_reference_t *ref, double e) {
+	if (!(((ref->u_old > BENCH_UKMAX) && (e > 0.0)) || ((ref->u_old < BENCH_UKMIN) && (e < 0.0)))) {
+		ref->sk += e;
+	}
+	double u = (ref->kp * e) + (ref->ki * ref->sk) + (ref->kd * (e - ref->e_old));
+	u = (u < BENCH_UKMIN) ? BENCH_UKMIN : ((u > BENCH_UKMAX) ? BENCH_UKMAX : u);
+	ref->e_old = e;
+	ref->u_old = u;
+	return u;
+}
+
+int main(int argc, char **argv) {
+	const uint32_t calls = (argc > 1) ? (uint32_t) strtoul(argv[1], NULL, 0) : BENCH_DEFAULT_CALLS;
+	bench_reference_t ref = { -4.4795, 0.0, -10.2476, 0.0, 0.0, 0.0 };
+	pid_t pid;
+	pid_signal_t u = 0;
+	double checksum = 0.0;
+	double max_deviation = 0.0;
+	int exit_code = EXIT_SUCCESS;
+
+	__build_errors();
+
+	/* Accuracy over one pass of the sequence, against the reference */
+	if (pid_init(&pid, PID_KP, PID_KI, PID_KD, BENCH_UKMIN, BENCH_UKMAX) != PID_OK) {
+		exit_code = EXIT_FAILURE;
+	}
+	for (uint32_t i = 0U; (i < BENCH_ERROR_CNT) && (exit_code == EXIT_SUCCESS); i++) {
+		(void) pid_calculate_output(&pid, signals[i], &u);
+		const double deviation = fabs((double) u - __reference_output(&ref, (double) signals[i]));
+		max_deviation = (deviation > max_deviation) ? deviation : max_deviation;
+	}
+
+	/* Cost of the calls alone */
+	if ((exit_code == EXIT_SUCCESS) &&
+		(pid_init(&pid, PID_KP, PID_KI, PID_KD, BENCH_UKMIN, BENCH_UKMAX) == PID_OK)) {
+		const double start = __wall_seconds();
+		for (uint32_t i = 0U; i < calls; i++) {
+			(void) pid_calculate_output(&pid, signals[i % BENCH_ERROR_CNT], &u);
+			checksum += (double) u;
+		}
+		const double elapsed = __wall_seconds() - start;
+
+		(void) printf("%-14s %u calls, %.2f ns/call, max deviation from double %.4f (checksum %.0f)\n",
+				BENCH_ENGINE, calls, (elapsed * 1e9) / (double) calls, max_deviation, checksum);
+	} else {
+		(void) fprintf(stderr, "pid_init failed\n");
+		exit_code = EXIT_FAILURE;
+	}
+
+	return exit_code;
+}
@@ -0,0 +1,352 @@
+/**
+ * @file usbh_stub.c
+ * @brief Simulated USB host core and T818 for the host build.
+ */
+
+#include "usbh_hid.h"
+#include "host_usbh.h"
+
+#define HOST_USBH_MAX_PIPES                (16U)
+#define HOST_USBH_CTRL_PIPES               (2U)
+#define HOST_USBH_T818_IN_EP               (0x81U)
+#define HOST_USBH_T818_OUT_EP              (0x01U)
+#define HOST_USBH_T818_MPS                 (64U)
+
+typedef struct {
+	uint8_t allocated;
+	uint8_t ep_addr;
+	uint8_t active;
+	uint8_t *buff;
+	uint8_t length;
+	USBH_URBStateTypeDef urb_state;
+	uint32_t xfer_size;
+} host_usbh_pipe_t;
+
+USBH_HandleTypeDef hUsbHostFS;
+
+/* Report descriptor of the simulated wheel, same field layout as the T818 */
+static const uint8_t t818_report_desc[] = {
+	0x05, 0x01, 0x09, 0x04, 0xA1, 0x01, 0x85, 0x01,
+	0x09, 0x30, 0x15, 0x00, 0x27, 0xFF, 0xFF, 0x00, 0x00, 0x75, 0x10, 0x95, 0x01, 0x81, 0x02,
+	0x09, 0x31, 0x09, 0x35, 0x09, 0x36, 0x26, 0xFF, 0x03, 0x95, 0x03, 0x81, 0x02,
+	0x09, 0x40, 0x09, 0x41, 0x09, 0x33, 0x09, 0x34, 0x09, 0x32, 0x26, 0xFF, 0x00, 0x75, 0x08, 0x95, 0x05, 0x81, 0x02,
+	0x75, 0x08, 0x95, 0x01, 0x81, 0x03,
+	0x05, 0x09, 0x19, 0x01, 0x29, 0x20, 0x25, 0x01, 0x75, 0x01, 0x95, 0x20, 0x81, 0x02,
+	0x05, 0x01, 0x09, 0x39, 0x25, 0x07, 0x75, 0x04, 0x95, 0x01, 0x81, 0x42,
+	0x75, 0x04, 0x95, 0x01, 0x81, 0x03,
+	0x06, 0x00, 0xFF, 0x09, 0x01, 0x75, 0x08, 0x95, 0x3F, 0x91, 0x02,
+	0xC0
+};
+
+/* Configuration, interface, HID, IN endpoint and OUT endpoint descriptors */
+static const uint8_t t818_cfg_desc[] = {
+	0x09, 0x02, 0x29, 0x00, 0x01, 0x01, 0x00, 0x80, 0xFA,
+	0x09, 0x04, 0x00, 0x00, 0x02, USB_HID_CLASS, 0x00, HID_NONE_BOOT_CODE, 0x00,
+	0x09, 0x21, 0x11, 0x01, 0x00, 0x01, 0x22, (uint8_t) sizeof(t818_report_desc), 0x00,
+	0x07, 0x05, HOST_USBH_T818_IN_EP, 0x03, HOST_USBH_T818_MPS, 0x00, 0x01,
+	0x07, 0x05, HOST_USBH_T818_OUT_EP, 0x03, HOST_USBH_T818_MPS, 0x00, 0x01
+};
+
+static host_usbh_pipe_t pipes[HOST_USBH_MAX_PIPES];
+static uint8_t t818_report[T818_REPORT_SIZE];
+static USBH_URBStateTypeDef out_fault_state = USBH_URB_DONE;
+static uint32_t out_fault_cnt = 0U;
+static uint32_t send_failure_cnt = 0U;
+static host_usbh_out_observer_t out_observer = NULL;
+static host_usbh_urb_change_t urb_change_callback = NULL;
+static host_usbh_stats_t stats;
+
+static void __user_process(USBH_HandleTypeDef *phost, uint8_t id) {
+	UNUSED(phost);
+	UNUSED(id);
+}
+
+static void __fill_t818_descriptors(USBH_HandleTypeDef *phost) {
+	USBH_InterfaceDescTypeDef *itf = &phost->device.CfgDesc.Itf_Desc[0];
+
+	phost->device.address = 1U;
+	phost->device.speed = USBH_SPEED_FULL;
+	phost->device.is_connected = 1U;
+	phost->device.current_interface = 0U;
+	phost->device.DevDesc.idVendor = T818_ID_VENDOR;
+	phost->device.DevDesc.idProduct = T818_ID_PRODUCT;
+	(void) memcpy(phost->device.CfgDesc_Raw, t818_cfg_desc, sizeof(t818_cfg_desc));
+	phost->device.CfgDesc.wTotalLength = (uint16_t) sizeof(t818_cfg_desc);
+	phost->device.CfgDesc.bNumInterfaces = 1U;
+	itf->bInterfaceNumber = 0U;
+	itf->bNumEndpoints = 2U;
+	itf->bInterfaceClass = USB_HID_CLASS;
+	itf->bInterfaceSubClass = 0U;
+	itf->bInterfaceProtocol = HID_NONE_BOOT_CODE;
+	itf->Ep_Desc[0].bEndpointAddress = HOST_USBH_T818_IN_EP;
+	itf->Ep_Desc[0].bmAttributes = USB_EP_TYPE_INTR;
+	itf->Ep_Desc[0].wMaxPacketSize = HOST_USBH_T818_MPS;
+	itf->Ep_Desc[0].bInterval = 1U;
+	itf->Ep_Desc[1].bEndpointAddress = HOST_USBH_T818_OUT_EP;
+	itf->Ep_Desc[1].bmAttributes = USB_EP_TYPE_INTR;
+	itf->Ep_Desc[1].wMaxPacketSize = HOST_USBH_T818_MPS;
+	itf->Ep_Desc[1].bInterval = 1U;
+}
+
+void host_usbh_attach_t818(void) {
+	USBH_HandleTypeDef *phost = &hUsbHostFS;
+	USBH_StatusTypeDef status = USBH_BUSY;
+
+	(void) memset(pipes, 0x00, sizeof(pipes));
+	(void) memset(t818_report, 0x00, sizeof(t818_report));
+	/* Pedals released, which is what the drive control waits for */
+	t818_report[0] = 0x01U;
+	t818_report[1] = 0x00U;
+	t818_report[2] = 0x80U;
+	for (uint32_t i = 3U; i < 9U; i += 2U) {
+		t818_report[i] = 0xFFU;
+		t818_report[i + 1U] = 0x03U;
+	}
+
+	phost->pUser = __user_process;
+	__fill_t818_descriptors(phost);
+	phost->pActiveClass = USBH_HID_CLASS;
+	phost->gState = HOST_CLASS_REQUEST;
+	if (phost->pActiveClass->Init(phost) == USBH_OK) {
+		while (status == USBH_BUSY) {
+			status = phost->pActiveClass->Requests(phost);
+		}
+	}
+	phost->gState = (status == USBH_OK) ? HOST_CLASS : HOST_ABORT_STATE;
+}
+
+void host_usbh_detach(void) {
+	USBH_HandleTypeDef *phost = &hUsbHostFS;
+
+	if (phost->pActiveClass != NULL) {
+		(void) phost->pActiveClass->DeInit(phost);
+		phost->pActiveClass = NULL;
+	}
+	phost->device.is_connected = 0U;
+	phost->gState = HOST_IDLE;
+	(void) memset(pipes, 0x00, sizeof(pipes));
+}
+
+void host_usbh_frame(void) {
+	USBH_HandleTypeDef *phost = &hUsbHostFS;
+
+	/* URBs submitted during the previous frame complete at this SOF */
+	for (uint8_t pipe = 0U; pipe < HOST_USBH_MAX_PIPES; pipe++) {
+		host_usbh_pipe_t *p = &pipes[pipe];
+		if ((p->active != 0U) && (p->urb_state == USBH_URB_IDLE)) {
+			p->active = 0U;
+			if ((p->ep_addr & USB_EP_DIR_IN) != 0U) {
+				(void) memcpy(p->buff, t818_report, (p->length < sizeof(t818_report)) ? p->length : sizeof(t818_report));
+				p->xfer_size = p->length;
+				p->urb_state = USBH_URB_DONE;
+				(stats.in_report_cnt)++;
+			} else if (out_fault_cnt > 0U) {
+				out_fault_cnt--;
+				p->xfer_size = 0U;
+				p->urb_state = out_fault_state;
+				(stats.out_fault_cnt)++;
+			} else {
+				p->xfer_size = p->length;
+				p->urb_state = USBH_URB_DONE;
+				(stats.out_done_cnt)++;
+				stats.out_bytes += p->length;
+				if (out_observer != NULL) {
+					out_observer(p->buff, p->length, pipe);
+				}
+			}
+			if (urb_change_callback != NULL) {
+				urb_change_callback(pipe);
+			}
+		}
+	}
+
+	(phost->Timer)++;
+	if ((phost->gState == HOST_CLASS) && (phost->pActiveClass != NULL)) {
+		(void) phost->pActiveClass->SOFProcess(phost);
+		(void) phost->pActiveClass->BgndProcess(phost);
+	}
+}
+
+uint8_t *host_usbh_t818_report(void) {
+	return t818_report;
+}
+
+void host_usbh_set_out_fault(USBH_URBStateTypeDef urb_state, uint32_t count) {
+	out_fault_state = urb_state;
+	out_fault_cnt = count;
+}
+
+void host_usbh_set_send_failures(uint32_t count) {
+	send_failure_cnt = count;
+}
+
+void host_usbh_set_out_observer(host_usbh_out_observer_t observer) {
+	out_observer = observer;
+}
+
+void host_usbh_set_urb_change_callback(host_usbh_urb_change_t callback) {
+	urb_change_callback = callback;
+}
+
+const host_usbh_stats_t *host_usbh_get_stats(void) {
+	return &stats;
+}
+
+/* Core ---------------------------------------------------------------------*/
+uint8_t USBH_FindInterface(USBH_HandleTypeDef *phost, uint8_t Class, uint8_t SubClass, uint8_t Protocol) {
+	uint8_t interface = 0xFFU;
+	for (uint8_t i = 0U; (i < phost->device.CfgDesc.bNumInterfaces) && (i < USBH_MAX_NUM_INTERFACES); i++) {
+		const USBH_InterfaceDescTypeDef *itf = &phost->device.CfgDesc.Itf_Desc[i];
+		if (((itf->bInterfaceClass == Class) || (Class == 0xFFU)) &&
+			((itf->bInterfaceSubClass == SubClass) || (SubClass == 0xFFU)) &&
+			((itf->bInterfaceProtocol == Protocol) || (Protocol == 0xFFU)) && (interface == 0xFFU)) {
+			interface = i;
+		}
+	}
+	return interface;
+}
+
+USBH_StatusTypeDef USBH_SelectInterface(USBH_HandleTypeDef *phost, uint8_t interface) {
+	USBH_StatusTypeDef status = USBH_FAIL;
+	if (interface < phost->device.CfgDesc.bNumInterfaces) {
+		phost->device.current_interface = interface;
+		status = USBH_OK;
+	}
+	return status;
+}
+
+USBH_DescHeader_t *USBH_GetNextDesc(uint8_t *pbuf, uint16_t *ptr) {
+	USBH_DescHeader_t *pnext;
+	*ptr += ((USBH_DescHeader_t *) (void *) pbuf)->bLength;
+	pnext = (USBH_DescHeader_t *) (void *) ((uint8_t *) pbuf + ((USBH_DescHeader_t *) (void *) pbuf)->bLength);
+	return pnext;
+}
+
+USBH_StatusTypeDef USBH_GetDescriptor(USBH_HandleTypeDef *phost, uint8_t req_type, uint16_t value_idx,
+                                      uint8_t *buff, uint16_t length) {
+	USBH_StatusTypeDef status = USBH_NOT_SUPPORTED;
+	UNUSED(phost);
+	UNUSED(req_type);
+	if (value_idx == USB_DESC_HID_REPORT) {
+		(void) memcpy(buff, t818_report_desc, (length < sizeof(t818_report_desc)) ? length : sizeof(t818_report_desc));
+		status = USBH_OK;
+	}
+	return status;
+}
+
+USBH_StatusTypeDef USBH_ClrFeature(USBH_HandleTypeDef *phost, uint8_t ep_num) {
+	UNUSED(phost);
+	UNUSED(ep_num);
+	return USBH_OK;
+}
+
+USBH_StatusTypeDef USBH_CtlReq(USBH_HandleTypeDef *phost, uint8_t *buff, uint16_t length) {
+	UNUSED(phost);
+	UNUSED(buff);
+	UNUSED(length);
+	return USBH_OK;
+}
+
+USBH_StatusTypeDef USBH_InterruptReceiveData(USBH_HandleTypeDef *phost, uint8_t *buff,
+                                             uint8_t length, uint8_t pipe_num) {
+	USBH_StatusTypeDef status = USBH_FAIL;
+	UNUSED(phost);
+	if ((pipe_num < HOST_USBH_MAX_PIPES) && (pipes[pipe_num].allocated != 0U)) {
+		pipes[pipe_num].buff = buff;
+		pipes[pipe_num].length = length;
+		pipes[pipe_num].urb_state = USBH_URB_IDLE;
+		pipes[pipe_num].active = 1U;
+		status = USBH_OK;
+	}
+	return status;
+}
+
+USBH_StatusTypeDef USBH_InterruptSendData(USBH_HandleTypeDef *phost, uint8_t *buff,
+                                          uint8_t length, uint8_t pipe_num) {
+	USBH_StatusTypeDef status = USBH_FAIL;
+	UNUSED(phost);
+	if (send_failure_cnt > 0U) {
+		send_failure_cnt--;
+		(stats.out_send_fail_cnt)++;
+	} else if ((pipe_num < HOST_USBH_MAX_PIPES) && (pipes[pipe_num].allocated != 0U)) {
+		pipes[pipe_num].buff = buff;
+		pipes[pipe_num].length = length;
+		pipes[pipe_num].urb_state = USBH_URB_IDLE;
+		pipes[pipe_num].active = 1U;
+		(stats.out_submit_cnt)++;
+		status = USBH_OK;
+	}
+	return status;
+}
+
+USBH_URBStateTypeDef USBH_LL_GetURBState(USBH_HandleTypeDef *phost, uint8_t pipe) {
+	UNUSED(phost);
+	return (pipe < HOST_USBH_MAX_PIPES) ? pipes[pipe].urb_state : USBH_URB_ERROR;
+}
+
+uint32_t USBH_LL_GetLastXferSize(USBH_HandleTypeDef *phost, uint8_t pipe) {
+	UNUSED(phost);
+	return (pipe < HOST_USBH_MAX_PIPES) ? pipes[pipe].xfer_size : 0U;
+}
+
+USBH_StatusTypeDef USBH_LL_SetToggle(USBH_HandleTypeDef *phost, uint8_t pipe, uint8_t toggle) {
+	UNUSED(phost);
+	UNUSED(pipe);
+	UNUSED(toggle);
+	return USBH_OK;
+}
+
+/* Pipes --------------------------------------------------------------------*/
+uint8_t USBH_AllocPipe(USBH_HandleTypeDef *phost, uint8_t ep_addr) {
+	uint8_t pipe = 0xFFU;
+	UNUSED(phost);
+	/* Pipes 0 and 1 belong to the control endpoint, as in the ST core */
+	for (uint8_t i = HOST_USBH_CTRL_PIPES; (i < HOST_USBH_MAX_PIPES) && (pipe == 0xFFU); i++) {
+		if (pipes[i].allocated == 0U) {
+			(void) memset(&pipes[i], 0x00, sizeof(pipes[i]));
+			pipes[i].allocated = 1U;
+			pipes[i].ep_addr = ep_addr;
+			pipe = i;
+		}
+	}
+	return pipe;
+}
+
+USBH_StatusTypeDef USBH_FreePipe(USBH_HandleTypeDef *phost, uint8_t idx) {
+	UNUSED(phost);
+	if (idx < HOST_USBH_MAX_PIPES) {
+		(void) memset(&pipes[idx], 0x00, sizeof(pipes[idx]));
+	}
+	return USBH_OK;
+}
+
+USBH_StatusTypeDef USBH_OpenPipe(USBH_HandleTypeDef *phost, uint8_t pipe_num, uint8_t epnum,
+                                 uint8_t dev_address, uint8_t speed, uint8_t ep_type, uint16_t mps) {
+	UNUSED(phost);
+	UNUSED(pipe_num);
+	UNUSED(epnum);
+	UNUSED(dev_address);
+	UNUSED(speed);
+	UNUSED(ep_type);
+	UNUSED(mps);
+	return USBH_OK;
+}
+
+USBH_StatusTypeDef USBH_ClosePipe(USBH_HandleTypeDef *phost, uint8_t pipe_num) {
+	UNUSED(phost);
+	if (pipe_num < HOST_USBH_MAX_PIPES) {
+		pipes[pipe_num].active = 0U;
+	}
+	return USBH_OK;
+}
+
+/* Boot protocol classes, never selected by the T818 --------------------------*/
+USBH_StatusTypeDef USBH_HID_MouseInit(USBH_HandleTypeDef *phost) {
+	UNUSED(phost);
+	return USBH_OK;
+}
+
+USBH_StatusTypeDef USBH_HID_KeybdInit(USBH_HandleTypeDef *phost) {
+	UNUSED(phost);
+	return USBH_OK;
+}
@@ -0,0 +1,20 @@
+/**
+ * @file virtual_clock.c
+ * @brief Virtual millisecond clock of the host build.
+ */
+
+#include "virtual_clock.h"
+
+static uint32_t virtual_tick = 0U;
+
+uint32_t virtual_clock_get_tick(void) {
+	return virtual_tick;
+}
+
+void virtual_clock_advance(uint32_t ms) {
+	virtual_tick += ms;
+}
+
+void virtual_clock_set(uint32_t tick) {
+	virtual_tick = tick;
+}
@@ -0,0 +1,36 @@
+/**
+ * @file virtual_clock.h
+ * @brief Virtual millisecond clock of the host build.
+ *
+ * HAL_GetTick(), and therefore CD_GET_TICK(), read this clock. It only moves
+ * when the harness advances it, so a simulation runs as fast as the host can
+ * execute the steps, independently of the wall clock.
+ */
+
+#ifndef HOST_VIRTUAL_CLOCK_H_
+#define HOST_VIRTUAL_CLOCK_H_
+
+#include <stdint.h>
+
+/**
+ * @brief Returns the current virtual tick.
+ *
+ * @return Virtual time in milliseconds, wrapping like the HAL tick.
+ */
+uint32_t virtual_clock_get_tick(void);
+
+/**
+ * @brief Moves the virtual clock forward.
+ *
+ * @param ms Number of milliseconds to advance.
+ */
+void virtual_clock_advance(uint32_t ms);
+
+/**
+ * @brief Sets the virtual clock, e.g. close to the wrap-around.
+ *
+ * @param tick New virtual time in milliseconds.
+ */
+void virtual_clock_set(uint32_t tick);
+
+#endif /* HOST_VIRTUAL_CLOCK_H_ */
@@ -0,0 +1,37 @@
+/**
+ * @file FreeRTOS.h
+ * @brief Host stand-in for the FreeRTOS kernel.
+ *
+ * The host runs every task body from one thread, so the kernel reduces to
+ * the queue and task notification calls made by the drivers, implemented in
+ * host/src/freertos_stub.c.
+ */
+
+#ifndef HOST_FREERTOS_H_
+#define HOST_FREERTOS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE                ((BaseType_t) 0)
+#define pdTRUE                 ((BaseType_t) 1)
+#define pdFAIL                 (pdFALSE)
+#define pdPASS                 (pdTRUE)
+#define errQUEUE_EMPTY         ((BaseType_t) 0)
+#define errQUEUE_FULL          ((BaseType_t) 0)
+#define portMAX_DELAY          ((TickType_t) 0xFFFFFFFFUL)
+#define configTICK_RATE_HZ     ((TickType_t) 1000U)
+#define pdMS_TO_TICKS(xTimeInMs) ((TickType_t) (((TickType_t) (xTimeInMs) * configTICK_RATE_HZ) / (TickType_t) 1000U))
+
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+#define portYIELD_FROM_ISR(x)  ((void) (x))
+
+#include "task.h"
+#include "queue.h"
+
+#endif /* HOST_FREERTOS_H_ */
@@ -0,0 +1,13 @@
+/**
+ * @file can.h
+ * @brief Host stand-in for the CubeMX can.h.
+ */
+
+#ifndef __CAN_H__
+#define __CAN_H__
+
+#include "main.h"
+
+extern CAN_HandleTypeDef hcan1;
+
+#endif /* __CAN_H__ */
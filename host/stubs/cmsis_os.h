@@ -0,0 +1,22 @@
+/**
+ * @file cmsis_os.h
+ * @brief Host stand-in for the CMSIS-RTOS v1 wrapper.
+ */
+
+#ifndef HOST_CMSIS_OS_H_
+#define HOST_CMSIS_OS_H_
+
+#include "FreeRTOS.h"
+
+#define osCMSIS                (0x10002U)
+
+typedef enum {
+	osOK = 0,
+	osErrorOS = 0xFF
+} osStatus;
+
+typedef QueueHandle_t osMessageQId;
+
+osStatus osMessagePut(osMessageQId queue_id, uint32_t info, uint32_t millisec);
+
+#endif /* HOST_CMSIS_OS_H_ */
@@ -0,0 +1,11 @@
+/**
+ * @file main.h
+ * @brief Host stand-in for the CubeMX main.h.
+ */
+
+#ifndef __MAIN_H
+#define __MAIN_H
+
+#include "stm32f4xx_hal.h"
+
+#endif /* __MAIN_H */
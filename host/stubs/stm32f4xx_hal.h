@@ -0,0 +1,44 @@
+/**
+ * @file stm32f4xx_hal.h
+ * @brief Host stand-in for the STM32F4 HAL.
+ *
+ * Declares only the HAL and CMSIS subset used by the drivers. The CAN
+ * peripheral is simulated by host/src/hal_can_stub.c.
+ */
+
+#ifndef HOST_STM32F4XX_HAL_H_
+#define HOST_STM32F4XX_HAL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define __weak   __attribute__((weak))
+#define UNUSED(X) ((void) (X))
+
+#define DISABLE  (0U)
+#define ENABLE   (1U)
+
+typedef enum {
+	HAL_OK = 0x00U,
+	HAL_ERROR = 0x01U,
+	HAL_BUSY = 0x02U,
+	HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+/* The host runs the drivers from a single thread, interrupts included */
+static inline void __disable_irq(void) {
+}
+
+static inline void __enable_irq(void) {
+}
+
+static inline void __DMB(void) {
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+uint32_t HAL_GetTick(void);
+
+#include "stm32f4xx_hal_can.h"
+
+#endif /* HOST_STM32F4XX_HAL_H_ */
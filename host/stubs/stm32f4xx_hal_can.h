@@ -0,0 +1,133 @@
+/**
+ * @file stm32f4xx_hal_can.h
+ * @brief Host stand-in for the STM32F4 HAL CAN driver.
+ *
+ * Same types, constants and functions as the HAL subset used by the CAN
+ * Manager. The flag values match the HAL ones.
+ */
+
+#ifndef HOST_STM32F4XX_HAL_CAN_H_
+#define HOST_STM32F4XX_HAL_CAN_H_
+
+#include <stdint.h>
+
+typedef struct {
+	volatile uint32_t TSR;
+	volatile uint32_t RF0R;
+	volatile uint32_t RF1R;
+	volatile uint32_t IER;
+	volatile uint32_t ESR;
+} CAN_TypeDef;
+
+typedef struct {
+	uint32_t StdId;
+	uint32_t ExtId;
+	uint32_t IDE;
+	uint32_t RTR;
+	uint32_t DLC;
+	uint32_t TransmitGlobalTime;
+} CAN_TxHeaderTypeDef;
+
+typedef struct {
+	uint32_t StdId;
+	uint32_t ExtId;
+	uint32_t IDE;
+	uint32_t RTR;
+	uint32_t DLC;
+	uint32_t Timestamp;
+	uint32_t FilterMatchIndex;
+} CAN_RxHeaderTypeDef;
+
+typedef struct {
+	uint32_t FilterIdHigh;
+	uint32_t FilterIdLow;
+	uint32_t FilterMaskIdHigh;
+	uint32_t FilterMaskIdLow;
+	uint32_t FilterFIFOAssignment;
+	uint32_t FilterBank;
+	uint32_t FilterMode;
+	uint32_t FilterScale;
+	uint32_t FilterActivation;
+	uint32_t SlaveStartFilterBank;
+} CAN_FilterTypeDef;
+
+typedef struct __CAN_HandleTypeDef {
+	CAN_TypeDef *Instance;
+	volatile uint32_t ErrorCode;
+} CAN_HandleTypeDef;
+
+#define CAN_ID_STD                    (0x00000000U)
+#define CAN_ID_EXT                    (0x00000004U)
+#define CAN_RTR_DATA                  (0x00000000U)
+#define CAN_RTR_REMOTE                (0x00000002U)
+
+#define CAN_RX_FIFO0                  (0x00000000U)
+#define CAN_RX_FIFO1                  (0x00000001U)
+
+#define CAN_TX_MAILBOX0               (0x00000001U)
+#define CAN_TX_MAILBOX1               (0x00000002U)
+#define CAN_TX_MAILBOX2               (0x00000004U)
+
+#define CAN_FILTERMODE_IDMASK         (0x00000000U)
+#define CAN_FILTERMODE_IDLIST         (0x00000001U)
+#define CAN_FILTERSCALE_16BIT         (0x00000000U)
+#define CAN_FILTERSCALE_32BIT         (0x00000001U)
+#define CAN_FILTER_DISABLE            (0x00000000U)
+#define CAN_FILTER_ENABLE             (0x00000001U)
+
+#define CAN_IT_TX_MAILBOX_EMPTY       (0x00000001U)
+#define CAN_IT_RX_FIFO0_MSG_PENDING   (0x00000002U)
+#define CAN_IT_RX_FIFO0_FULL          (0x00000004U)
+#define CAN_IT_RX_FIFO0_OVERRUN       (0x00000008U)
+#define CAN_IT_RX_FIFO1_MSG_PENDING   (0x00000010U)
+#define CAN_IT_RX_FIFO1_FULL          (0x00000020U)
+#define CAN_IT_RX_FIFO1_OVERRUN       (0x00000040U)
+
+#define HAL_CAN_ERROR_NONE            (0x00000000U)
+#define HAL_CAN_ERROR_EWG             (0x00000001U)
+#define HAL_CAN_ERROR_EPV             (0x00000002U)
+#define HAL_CAN_ERROR_BOF             (0x00000004U)
+#define HAL_CAN_ERROR_RX_FOV0         (0x00000200U)
+#define HAL_CAN_ERROR_RX_FOV1         (0x00000400U)
+#define HAL_CAN_ERROR_TX_ALST0        (0x00000800U)
+#define HAL_CAN_ERROR_TX_TERR0        (0x00001000U)
+#define HAL_CAN_ERROR_TX_ALST1        (0x00002000U)
+#define HAL_CAN_ERROR_TX_TERR1        (0x00004000U)
+#define HAL_CAN_ERROR_TX_ALST2        (0x00008000U)
+#define HAL_CAN_ERROR_TX_TERR2        (0x00010000U)
+
+#define CAN_ESR_EWGF                  (0x00000001U)
+#define CAN_ESR_EPVF                  (0x00000002U)
+#define CAN_ESR_BOFF                  (0x00000004U)
+#define CAN_ESR_LEC_Pos               (4U)
+#define CAN_ESR_LEC_Msk               (0x7UL << CAN_ESR_LEC_Pos)
+#define CAN_ESR_TEC_Pos               (16U)
+#define CAN_ESR_TEC_Msk               (0xFFUL << CAN_ESR_TEC_Pos)
+#define CAN_ESR_REC_Pos               (24U)
+#define CAN_ESR_REC_Msk               (0xFFUL << CAN_ESR_REC_Pos)
+
+HAL_StatusTypeDef HAL_CAN_ConfigFilter(CAN_HandleTypeDef *hcan, const CAN_FilterTypeDef *sFilterConfig);
+HAL_StatusTypeDef HAL_CAN_Start(CAN_HandleTypeDef *hcan);
+HAL_StatusTypeDef HAL_CAN_ActivateNotification(CAN_HandleTypeDef *hcan, uint32_t ActiveITs);
+HAL_StatusTypeDef HAL_CAN_AddTxMessage(CAN_HandleTypeDef *hcan, const CAN_TxHeaderTypeDef *pHeader,
+		const uint8_t aData[], uint32_t *pTxMailbox);
+HAL_StatusTypeDef HAL_CAN_AbortTxRequest(CAN_HandleTypeDef *hcan, uint32_t TxMailboxes);
+uint32_t HAL_CAN_GetTxMailboxesFreeLevel(const CAN_HandleTypeDef *hcan);
+uint32_t HAL_CAN_IsTxMessagePending(const CAN_HandleTypeDef *hcan, uint32_t TxMailboxes);
+HAL_StatusTypeDef HAL_CAN_GetRxMessage(CAN_HandleTypeDef *hcan, uint32_t RxFifo,
+		CAN_RxHeaderTypeDef *pHeader, uint8_t aData[]);
+uint32_t HAL_CAN_GetRxFifoFillLevel(const CAN_HandleTypeDef *hcan, uint32_t RxFifo);
+uint32_t HAL_CAN_GetError(const CAN_HandleTypeDef *hcan);
+HAL_StatusTypeDef HAL_CAN_ResetError(CAN_HandleTypeDef *hcan);
+
+void HAL_CAN_TxMailbox0CompleteCallback(CAN_HandleTypeDef *hcan);
+void HAL_CAN_TxMailbox1CompleteCallback(CAN_HandleTypeDef *hcan);
+void HAL_CAN_TxMailbox2CompleteCallback(CAN_HandleTypeDef *hcan);
+void HAL_CAN_TxMailbox0AbortCallback(CAN_HandleTypeDef *hcan);
+void HAL_CAN_TxMailbox1AbortCallback(CAN_HandleTypeDef *hcan);
+void HAL_CAN_TxMailbox2AbortCallback(CAN_HandleTypeDef *hcan);
+void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan);
+void HAL_CAN_RxFifo1MsgPendingCallback(CAN_HandleTypeDef *hcan);
+void HAL_CAN_ErrorCallback(CAN_HandleTypeDef *hcan);
+
+#endif /* HOST_STM32F4XX_HAL_CAN_H_ */
@@ -0,0 +1,33 @@
+/**
+ * @file usbh_conf.h
+ * @brief Host configuration of the USB host library stand-in.
+ */
+
+#ifndef HOST_USBH_CONF_H_
+#define HOST_USBH_CONF_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "main.h"
+
+#define USBH_MAX_NUM_ENDPOINTS                2U
+#define USBH_MAX_NUM_INTERFACES               2U
+#define USBH_MAX_NUM_CONFIGURATION            1U
+#define USBH_KEEP_CFG_DESCRIPTOR              1U
+#define USBH_MAX_NUM_SUPPORTED_CLASS          1U
+#define USBH_MAX_SIZE_CONFIGURATION           256U
+#define USBH_MAX_DATA_BUFFER                  512U
+#define USBH_DEBUG_LEVEL                      0U
+#define USBH_USE_OS                           0U
+
+#define USBH_malloc                           malloc
+#define USBH_free                             free
+#define USBH_memset                           memset
+#define USBH_memcpy                           memcpy
+
+#define USBH_UsrLog(...)                      do {} while (0)
+#define USBH_ErrLog(...)                      do {} while (0)
+#define USBH_DbgLog(...)                      do {} while (0)
+
+#endif /* HOST_USBH_CONF_H_ */
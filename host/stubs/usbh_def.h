@@ -0,0 +1,243 @@
+/**
+ * @file usbh_def.h
+ * @brief Host stand-in for the ST USB host library definitions.
+ *
+ * Keeps the layout and names of the ST types for the fields used by the HID
+ * class, the other fields are left out.
+ */
+
+#ifndef HOST_USBH_DEF_H_
+#define HOST_USBH_DEF_H_
+
+#include "usbh_conf.h"
+
+#ifndef NULL
+#define NULL  0U
+#endif
+
+#define ValBit(VAR, POS)                      ((VAR) & (1 << (POS)))
+#define SetBit(VAR, POS)                      ((VAR) |= (1 << (POS)))
+#define ClrBit(VAR, POS)                      ((VAR) &= ((1 << (POS)) ^ 255))
+
+#define LE16(addr)                            (((uint16_t)(addr)[0]) | \
+                                               ((uint16_t)(((uint32_t)(addr)[1]) << 8)))
+
+#define USB_LEN_DESC_HDR                      0x02U
+#define USB_LEN_DEV_DESC                      0x12U
+#define USB_LEN_CFG_DESC                      0x09U
+#define USB_LEN_IF_DESC                       0x09U
+#define USB_LEN_EP_DESC                       0x07U
+
+#define USB_CONFIGURATION_DESC_SIZE           0x09U
+#define USB_INTERFACE_DESC_SIZE               0x09U
+#define USB_ENDPOINT_DESC_SIZE                0x07U
+
+#define USB_REQ_DIR_MASK                      0x80U
+#define USB_H2D                               0x00U
+#define USB_D2H                               0x80U
+
+#define USB_REQ_TYPE_STANDARD                 0x00U
+#define USB_REQ_TYPE_CLASS                    0x20U
+#define USB_REQ_TYPE_VENDOR                   0x40U
+
+#define USB_REQ_RECIPIENT_DEVICE              0x00U
+#define USB_REQ_RECIPIENT_INTERFACE           0x01U
+#define USB_REQ_RECIPIENT_ENDPOINT            0x02U
+
+#define USB_REQ_GET_DESCRIPTOR                0x06U
+
+#define USB_DESC_TYPE_DEVICE                  0x01U
+#define USB_DESC_TYPE_CONFIGURATION           0x02U
+#define USB_DESC_TYPE_INTERFACE               0x04U
+#define USB_DESC_TYPE_ENDPOINT                0x05U
+#define USB_DESC_TYPE_HID                     0x21U
+#define USB_DESC_TYPE_HID_REPORT              0x22U
+
+#define USB_DESC_HID_REPORT                   ((USB_DESC_TYPE_HID_REPORT << 8) & 0xFF00U)
+#define USB_DESC_HID                          ((USB_DESC_TYPE_HID << 8) & 0xFF00U)
+
+#define USB_EP_TYPE_CTRL                      0x00U
+#define USB_EP_TYPE_ISOC                      0x01U
+#define USB_EP_TYPE_BULK                      0x02U
+#define USB_EP_TYPE_INTR                      0x03U
+
+#define USB_EP_DIR_OUT                        0x00U
+#define USB_EP_DIR_IN                         0x80U
+
+#define HOST_USER_SELECT_CONFIGURATION        0x01U
+#define HOST_USER_CLASS_ACTIVE                0x02U
+#define HOST_USER_CLASS_SELECTED              0x03U
+#define HOST_USER_CONNECTION                  0x04U
+#define HOST_USER_DISCONNECTION               0x05U
+#define HOST_USER_UNRECOVERED_ERROR           0x06U
+
+typedef union {
+  uint16_t w;
+  struct BW {
+    uint8_t msb;
+    uint8_t lsb;
+  } bw;
+} uint16_t_uint8_t;
+
+typedef union _USB_Setup {
+  uint32_t d8[2];
+  struct _SetupPkt_Struc {
+    uint8_t bmRequestType;
+    uint8_t bRequest;
+    uint16_t_uint8_t wValue;
+    uint16_t_uint8_t wIndex;
+    uint16_t_uint8_t wLength;
+  } b;
+} USB_Setup_TypeDef;
+
+typedef struct _DescHeader {
+  uint8_t bLength;
+  uint8_t bDescriptorType;
+} USBH_DescHeader_t;
+
+typedef struct _DeviceDescriptor {
+  uint8_t bLength;
+  uint8_t bDescriptorType;
+  uint16_t bcdUSB;
+  uint8_t bDeviceClass;
+  uint8_t bDeviceSubClass;
+  uint8_t bDeviceProtocol;
+  uint8_t bMaxPacketSize;
+  uint16_t idVendor;
+  uint16_t idProduct;
+  uint16_t bcdDevice;
+  uint8_t iManufacturer;
+  uint8_t iProduct;
+  uint8_t iSerialNumber;
+  uint8_t bNumConfigurations;
+} USBH_DevDescTypeDef;
+
+typedef struct _EndpointDescriptor {
+  uint8_t bLength;
+  uint8_t bDescriptorType;
+  uint8_t bEndpointAddress;
+  uint8_t bmAttributes;
+  uint16_t wMaxPacketSize;
+  uint8_t bInterval;
+} USBH_EpDescTypeDef;
+
+typedef struct _InterfaceDescriptor {
+  uint8_t bLength;
+  uint8_t bDescriptorType;
+  uint8_t bInterfaceNumber;
+  uint8_t bAlternateSetting;
+  uint8_t bNumEndpoints;
+  uint8_t bInterfaceClass;
+  uint8_t bInterfaceSubClass;
+  uint8_t bInterfaceProtocol;
+  uint8_t iInterface;
+  USBH_EpDescTypeDef Ep_Desc[USBH_MAX_NUM_ENDPOINTS];
+} USBH_InterfaceDescTypeDef;
+
+typedef struct _ConfigurationDescriptor {
+  uint8_t bLength;
+  uint8_t bDescriptorType;
+  uint16_t wTotalLength;
+  uint8_t bNumInterfaces;
+  uint8_t bConfigurationValue;
+  uint8_t iConfiguration;
+  uint8_t bmAttributes;
+  uint8_t bMaxPower;
+  USBH_InterfaceDescTypeDef Itf_Desc[USBH_MAX_NUM_INTERFACES];
+} USBH_CfgDescTypeDef;
+
+typedef enum {
+  USBH_OK = 0,
+  USBH_BUSY,
+  USBH_FAIL,
+  USBH_NOT_SUPPORTED,
+  USBH_UNRECOVERED_ERROR,
+  USBH_ERROR_SPEED_UNKNOWN,
+} USBH_StatusTypeDef;
+
+typedef enum {
+  USBH_SPEED_HIGH = 0U,
+  USBH_SPEED_FULL = 1U,
+  USBH_SPEED_LOW = 2U,
+} USBH_SpeedTypeDef;
+
+typedef enum {
+  HOST_IDLE = 0U,
+  HOST_DEV_WAIT_FOR_ATTACHMENT,
+  HOST_DEV_ATTACHED,
+  HOST_DEV_DISCONNECTED,
+  HOST_DETECT_DEVICE_SPEED,
+  HOST_ENUMERATION,
+  HOST_CLASS_REQUEST,
+  HOST_INPUT,
+  HOST_SET_CONFIGURATION,
+  HOST_SET_WAKEUP_FEATURE,
+  HOST_CHECK_CLASS,
+  HOST_CLASS,
+  HOST_SUSPENDED,
+  HOST_ABORT_STATE,
+} HOST_StateTypeDef;
+
+typedef enum {
+  USBH_URB_IDLE = 0U,
+  USBH_URB_DONE,
+  USBH_URB_NOTREADY,
+  USBH_URB_NYET,
+  USBH_URB_ERROR,
+  USBH_URB_STALL
+} USBH_URBStateTypeDef;
+
+typedef enum {
+  USBH_PORT_EVENT = 1U,
+  USBH_URB_EVENT,
+  USBH_CONTROL_EVENT,
+  USBH_CLASS_EVENT,
+  USBH_STATE_CHANGED_EVENT,
+} USBH_OSEventTypeDef;
+
+typedef struct {
+  uint8_t pipe_in;
+  uint8_t pipe_out;
+  uint8_t pipe_size;
+  uint8_t *buff;
+  uint16_t length;
+  uint16_t timer;
+  USB_Setup_TypeDef setup;
+  uint8_t errorcount;
+} USBH_CtrlTypeDef;
+
+typedef struct {
+  uint8_t Data[USBH_MAX_DATA_BUFFER];
+  uint8_t address;
+  uint8_t speed;
+  volatile uint8_t is_connected;
+  uint8_t current_interface;
+  USBH_DevDescTypeDef DevDesc;
+  USBH_CfgDescTypeDef CfgDesc;
+  uint8_t CfgDesc_Raw[USBH_MAX_SIZE_CONFIGURATION];
+} USBH_DeviceTypeDef;
+
+struct _USBH_HandleTypeDef;
+
+typedef struct {
+  const char *Name;
+  uint8_t ClassCode;
+  USBH_StatusTypeDef (*Init)(struct _USBH_HandleTypeDef *phost);
+  USBH_StatusTypeDef (*DeInit)(struct _USBH_HandleTypeDef *phost);
+  USBH_StatusTypeDef (*Requests)(struct _USBH_HandleTypeDef *phost);
+  USBH_StatusTypeDef (*BgndProcess)(struct _USBH_HandleTypeDef *phost);
+  USBH_StatusTypeDef (*SOFProcess)(struct _USBH_HandleTypeDef *phost);
+  void *pData;
+} USBH_ClassTypeDef;
+
+typedef struct _USBH_HandleTypeDef {
+  volatile HOST_StateTypeDef gState;
+  USBH_CtrlTypeDef Control;
+  USBH_DeviceTypeDef device;
+  USBH_ClassTypeDef *pActiveClass;
+  volatile uint32_t Timer;
+  void *pData;
+  void (*pUser)(struct _USBH_HandleTypeDef *pHandle, uint8_t id);
+} USBH_HandleTypeDef;
+
+#endif /* HOST_USBH_DEF_H_ */
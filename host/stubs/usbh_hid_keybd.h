@@ -0,0 +1,13 @@
+/**
+ * @file usbh_hid_keybd.h
+ * @brief Host stand-in for the ST HID keyboard class header.
+ */
+
+#ifndef HOST_USBH_HID_KEYBD_H_
+#define HOST_USBH_HID_KEYBD_H_
+
+#include "usbh_core.h"
+
+USBH_StatusTypeDef USBH_HID_KeybdInit(USBH_HandleTypeDef *phost);
+
+#endif /* HOST_USBH_HID_KEYBD_H_ */
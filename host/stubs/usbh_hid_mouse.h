@@ -0,0 +1,13 @@
+/**
+ * @file usbh_hid_mouse.h
+ * @brief Host stand-in for the ST HID mouse class header.
+ */
+
+#ifndef HOST_USBH_HID_MOUSE_H_
+#define HOST_USBH_HID_MOUSE_H_
+
+#include "usbh_core.h"
+
+USBH_StatusTypeDef USBH_HID_MouseInit(USBH_HandleTypeDef *phost);
+
+#endif /* HOST_USBH_HID_MOUSE_H_ */
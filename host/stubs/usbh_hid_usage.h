@@ -0,0 +1,12 @@
+/**
+ * @file usbh_hid_usage.h
+ * @brief Host stand-in for the ST HID usage table, no usage is referenced by name.
+ */
+
+#ifndef HOST_USBH_HID_USAGE_H_
+#define HOST_USBH_HID_USAGE_H_
+
+#define HID_USAGE_PAGE_GEN_DES                (0x01U)
+#define HID_USAGE_PAGE_BUTTON                 (0x09U)
+
+#endif /* HOST_USBH_HID_USAGE_H_ */
@@ -0,0 +1,18 @@
+/**
+ * @file usbh_ioreq.h
+ * @brief Host stand-in for the ST USB host I/O requests.
+ */
+
+#ifndef HOST_USBH_IOREQ_H_
+#define HOST_USBH_IOREQ_H_
+
+#include "usbh_conf.h"
+#include "usbh_def.h"
+
+USBH_StatusTypeDef USBH_CtlReq(USBH_HandleTypeDef *phost, uint8_t *buff, uint16_t length);
+USBH_StatusTypeDef USBH_InterruptReceiveData(USBH_HandleTypeDef *phost, uint8_t *buff,
+                                             uint8_t length, uint8_t pipe_num);
+USBH_StatusTypeDef USBH_InterruptSendData(USBH_HandleTypeDef *phost, uint8_t *buff,
+                                          uint8_t length, uint8_t pipe_num);
+
+#endif /* HOST_USBH_IOREQ_H_ */
@@ -0,0 +1,17 @@
+/**
+ * @file usbh_pipes.h
+ * @brief Host stand-in for the ST USB host pipe management.
+ */
+
+#ifndef HOST_USBH_PIPES_H_
+#define HOST_USBH_PIPES_H_
+
+#include "usbh_def.h"
+
+USBH_StatusTypeDef USBH_OpenPipe(USBH_HandleTypeDef *phost, uint8_t pipe_num, uint8_t epnum,
+                                 uint8_t dev_address, uint8_t speed, uint8_t ep_type, uint16_t mps);
+USBH_StatusTypeDef USBH_ClosePipe(USBH_HandleTypeDef *phost, uint8_t pipe_num);
+uint8_t USBH_AllocPipe(USBH_HandleTypeDef *phost, uint8_t ep_addr);
+USBH_StatusTypeDef USBH_FreePipe(USBH_HandleTypeDef *phost, uint8_t idx);
+
+#endif /* HOST_USBH_PIPES_H_ */